@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# athAgent: remote capture agent, runs on the AP
+#
+#-------------------------------------------------
+
+TARGET = athAgent
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= qt app_bundle
+
+QMAKE_CFLAGS += -std=gnu99
+
+SOURCES += athagent.c
+
+HEADERS += scanproto.h
+
+LIBS += -lz
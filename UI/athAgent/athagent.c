@@ -0,0 +1,476 @@
+/* athAgent: stream the spectral samples of an Atheros NIC to athScan
+ *
+ * The agent reads the fft_sample TLVs reported by the driver (or stored
+ * in a capture), batches whole records in large frames and sends them to
+ * one client at a time over a TCP or a Unix socket, see scanproto.h.
+ * Records are never sent one by one: a frame costs a single writev().
+ * When the client is too slow to accept a frame read from the driver,
+ * the frame is dropped and its sequence number is skipped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <zlib.h>
+
+#include "scanproto.h"
+
+#define AGENT_DEFAULT_INPUT     "/sys/kernel/debug/ieee80211/phy0/ath9k/spectral_scan0"
+/* default size of the batch of records sent in a frame */
+#define AGENT_BATCH_LEN         (64 * 1024)
+/* default maximum delay of a record in a partial batch */
+#define AGENT_FLUSH_MS          50
+/* delay between two reads of an empty driver file */
+#define AGENT_IDLE_MS           10
+
+/* record lengths, see fft_sample_* in athScan/athscan.h */
+#define AGENT_HT20_LEN          76
+#define AGENT_HT20_40_LEN       155
+#define AGENT_ATH10K_HDR_LEN    29
+#define AGENT_ATH10K_MAX_BINS   1024
+/* largest record accepted: ath10k samples with 1024 bins */
+#define AGENT_MAX_RECORD_LEN    (AGENT_ATH10K_HDR_LEN + AGENT_ATH10K_MAX_BINS)
+
+enum {
+    ATH_FFT_SAMPLE_HT20 = 1,
+    ATH_FFT_SAMPLE_HT20_40,
+    ATH_FFT_SAMPLE_ATH10K
+};
+
+struct agent {
+    const char *input;
+    const char *address;
+    const char *unix_path;
+    size_t batch_len;
+    int flush_ms;
+    int compress;
+
+    int in_fd;
+    int regular;
+    int listen_fd;
+    int client_fd;
+
+    uint8_t *buf;
+    size_t buf_len, fill;
+
+    uint8_t *zbuf;
+    size_t zbuf_len;
+
+    uint32_t seq;
+    uint64_t frames, records, dropped, bytes, resync;
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+    (void) sig;
+    stop = 1;
+}
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-i input] [-l [host:]port | -u path] [-b batch] [-t ms] [-z]\n"
+            "  -i  file to read the samples from (default %s)\n"
+            "  -l  TCP address to listen on (default port %d)\n"
+            "  -u  Unix socket to listen on\n"
+            "  -b  size of the batches sent in a frame (default %d)\n"
+            "  -t  maximum delay of a partial batch in ms (default %d)\n"
+            "  -z  compress the frames\n",
+            prog, AGENT_DEFAULT_INPUT, SCAN_AGENT_PORT,
+            AGENT_BATCH_LEN, AGENT_FLUSH_MS);
+}
+
+static int listen_tcp(const char *address)
+{
+    char host[256] = "", port[16];
+    struct addrinfo hints, *res, *ai;
+    const char *sep = strrchr(address, ':');
+    int fd = -1, on = 1;
+
+    if (sep) {
+        snprintf(host, sizeof(host), "%.*s", (int) (sep - address), address);
+        snprintf(port, sizeof(port), "%s", sep + 1);
+    } else {
+        snprintf(port, sizeof(port), "%s", address);
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    if (getaddrinfo(host[0] ? host : NULL, port, &hints, &res))
+        return -1;
+
+    for (ai = res; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (!bind(fd, ai->ai_addr, ai->ai_addrlen) && !listen(fd, 1))
+            break;
+
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+
+    return fd;
+}
+
+static int listen_unix(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return -1;
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) || listen(fd, 1)) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/* length of the record at ptr, 0 if more data are needed, -1 if ptr
+ * does not point to a valid record
+ */
+static int record_len(const uint8_t *ptr, size_t avail)
+{
+    size_t len;
+
+    if (avail < 3)
+        return 0;
+
+    if (ptr[0] < ATH_FFT_SAMPLE_HT20 || ptr[0] > ATH_FFT_SAMPLE_ATH10K)
+        return -1;
+
+    /* the same lengths as the decoders of athScan accept */
+    len = 3 + ((ptr[1] << 8) | ptr[2]);
+    switch (ptr[0]) {
+    case ATH_FFT_SAMPLE_HT20:
+        if (len != AGENT_HT20_LEN)
+            return -1;
+        break;
+    case ATH_FFT_SAMPLE_HT20_40:
+        if (len != AGENT_HT20_40_LEN)
+            return -1;
+        break;
+    default:
+        if (len <= AGENT_ATH10K_HDR_LEN || len > AGENT_MAX_RECORD_LEN)
+            return -1;
+        break;
+    }
+
+    return (len > avail) ? 0 : (int) len;
+}
+
+static int write_full(int fd, struct iovec *iov, int iovcnt)
+{
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        while (iovcnt > 0 && (size_t) n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (uint8_t *) iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+
+    return 0;
+}
+
+/* send the len bytes at data, made of records whole TLVs */
+static int send_frame(struct agent *agent, const uint8_t *data, size_t len,
+                      uint16_t records)
+{
+    struct scan_frame_hdr hdr;
+    struct iovec iov[2];
+    struct pollfd pfd;
+    const uint8_t *payload = data;
+    size_t payload_len = len;
+    uint8_t flags = 0;
+
+    /* the client is late: drop the frame instead of stalling the reads
+     * of the driver. Captures are sent without loss
+     */
+    pfd.fd = agent->client_fd;
+    pfd.events = POLLOUT;
+    if (!agent->regular &&
+        (poll(&pfd, 1, 0) <= 0 || !(pfd.revents & POLLOUT))) {
+        agent->seq++;
+        agent->dropped++;
+        return 0;
+    }
+
+    if (agent->compress) {
+        uLongf zlen = agent->zbuf_len - 4;
+
+        if (compress2(agent->zbuf + 4, &zlen, data, len, 1) == Z_OK &&
+            zlen + 4 < len) {
+            uint32_t raw_len = htonl(len);
+
+            memcpy(agent->zbuf, &raw_len, 4);
+            payload = agent->zbuf;
+            payload_len = zlen + 4;
+            flags |= SCAN_FRAME_COMPRESSED;
+        }
+    }
+
+    hdr.magic = htonl(SCAN_FRAME_MAGIC);
+    hdr.version = SCAN_FRAME_VERSION;
+    hdr.flags = flags;
+    hdr.records = htons(records);
+    hdr.seq = htonl(agent->seq++);
+    hdr.raw_len = htonl(len);
+    hdr.len = htonl(payload_len);
+
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = (void *) payload;
+    iov[1].iov_len = payload_len;
+
+    if (write_full(agent->client_fd, iov, 2) < 0)
+        return -1;
+
+    agent->frames++;
+    agent->records += records;
+    agent->bytes += sizeof(hdr) + payload_len;
+
+    return 0;
+}
+
+/* send the complete records of the buffer, keep the last partial one.
+ * A frame holds at most UINT16_MAX records, a large buffer of short
+ * records is sent in several frames
+ */
+static int flush_records(struct agent *agent)
+{
+    size_t start = 0, pos = 0;
+
+    for (;;) {
+        uint16_t records = 0;
+
+        while (pos < agent->fill && records < UINT16_MAX) {
+            int len = record_len(agent->buf + pos, agent->fill - pos);
+            if (len == 0)
+                break;
+
+            if (len < 0) {
+                /* not a record boundary: drop a byte and resync */
+                memmove(agent->buf + pos, agent->buf + pos + 1, agent->fill - pos - 1);
+                agent->fill--;
+                agent->resync++;
+                continue;
+            }
+
+            pos += len;
+            records++;
+        }
+
+        if (!records)
+            break;
+
+        if (send_frame(agent, agent->buf + start, pos - start, records) < 0)
+            return -1;
+        start = pos;
+    }
+
+    memmove(agent->buf, agent->buf + pos, agent->fill - pos);
+    agent->fill -= pos;
+
+    return 0;
+}
+
+static int stream(struct agent *agent)
+{
+    uint64_t last_flush = now_ms();
+
+    agent->fill = 0;
+    while (!stop) {
+        ssize_t n = read(agent->in_fd, agent->buf + agent->fill,
+                         agent->buf_len - agent->fill);
+        if (n < 0 && errno != EINTR && errno != EAGAIN)
+            return -1;
+
+        if (n > 0)
+            agent->fill += n;
+
+        uint64_t now = now_ms();
+        if (agent->fill >= agent->batch_len ||
+            (agent->fill && now - last_flush >= (uint64_t) agent->flush_ms) ||
+            (n == 0 && agent->regular)) {
+            if (flush_records(agent) < 0)
+                return -1;
+            last_flush = now;
+        }
+
+        if (n == 0) {
+            /* end of a capture */
+            if (agent->regular)
+                return 1;
+            usleep(AGENT_IDLE_MS * 1000);
+        }
+    }
+
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    struct agent agent;
+    struct sigaction sa;
+    int opt, ret = 0;
+
+    memset(&agent, 0, sizeof(agent));
+    agent.input = AGENT_DEFAULT_INPUT;
+    agent.batch_len = AGENT_BATCH_LEN;
+    agent.flush_ms = AGENT_FLUSH_MS;
+    agent.client_fd = -1;
+
+    while ((opt = getopt(argc, argv, "i:l:u:b:t:zh")) != -1) {
+        switch (opt) {
+        case 'i':
+            agent.input = optarg;
+            break;
+        case 'l':
+            agent.address = optarg;
+            break;
+        case 'u':
+            agent.unix_path = optarg;
+            break;
+        case 'b':
+            agent.batch_len = strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            agent.flush_ms = atoi(optarg);
+            break;
+        case 'z':
+            agent.compress = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (agent.batch_len < AGENT_MAX_RECORD_LEN)
+        agent.batch_len = AGENT_MAX_RECORD_LEN;
+    if (agent.batch_len > SCAN_FRAME_MAX_LEN - AGENT_MAX_RECORD_LEN)
+        agent.batch_len = SCAN_FRAME_MAX_LEN - AGENT_MAX_RECORD_LEN;
+
+    /* a full batch followed by a partial record */
+    agent.buf_len = agent.batch_len + AGENT_MAX_RECORD_LEN;
+    agent.buf = malloc(agent.buf_len);
+    agent.zbuf_len = compressBound(agent.buf_len) + 4;
+    agent.zbuf = malloc(agent.zbuf_len);
+    if (!agent.buf || !agent.zbuf)
+        return 1;
+
+    /* no SA_RESTART: accept() and read() have to return on signals */
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (agent.unix_path) {
+        agent.listen_fd = listen_unix(agent.unix_path);
+    } else {
+        char port[16];
+
+        snprintf(port, sizeof(port), "%d", SCAN_AGENT_PORT);
+        agent.listen_fd = listen_tcp(agent.address ? agent.address : port);
+    }
+    if (agent.listen_fd < 0) {
+        perror("listen");
+        return 1;
+    }
+
+    while (!stop) {
+        struct stat st;
+
+        agent.client_fd = accept(agent.listen_fd, NULL, NULL);
+        if (agent.client_fd < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("accept");
+            ret = 1;
+            break;
+        }
+
+        /* every client gets the capture from its beginning */
+        agent.in_fd = open(agent.input, O_RDONLY);
+        if (agent.in_fd < 0) {
+            perror(agent.input);
+            close(agent.client_fd);
+            ret = 1;
+            break;
+        }
+        agent.regular = !fstat(agent.in_fd, &st) && S_ISREG(st.st_mode);
+
+        stream(&agent);
+
+        close(agent.in_fd);
+        close(agent.client_fd);
+        agent.client_fd = -1;
+
+        fprintf(stderr, "frames %llu records %llu bytes %llu dropped %llu resync %llu\n",
+                (unsigned long long) agent.frames, (unsigned long long) agent.records,
+                (unsigned long long) agent.bytes, (unsigned long long) agent.dropped,
+                (unsigned long long) agent.resync);
+    }
+
+    close(agent.listen_fd);
+    if (agent.unix_path)
+        unlink(agent.unix_path);
+
+    free(agent.buf);
+    free(agent.zbuf);
+
+    return ret;
+}
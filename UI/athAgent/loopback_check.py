@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+#
+# Loopback check of the athAgent streaming protocol, see scanproto.h
+#
+# Every capture is served by the agent over a Unix socket, plain and
+# compressed, with the default, a small and a large batch size. The
+# frames are checked the way ScanNetSource reads them and the received
+# TLVs have to be the records of the capture, byte for byte.
+#
+# usage: loopback_check.py path/to/athAgent capture.log...
+
+import os
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+import zlib
+
+SCAN_FRAME_MAGIC = 0x41544853
+SCAN_FRAME_VERSION = 1
+SCAN_FRAME_COMPRESSED = 0x01
+SCAN_FRAME_MAX_LEN = 4 * 1024 * 1024
+
+# struct scan_frame_hdr
+HDR = struct.Struct('>IBBHIII')
+
+# record lengths, see record_len() in athagent.c
+HT20_LEN = 76
+HT20_40_LEN = 155
+ATH10K_HDR_LEN = 29
+ATH10K_MAX_BINS = 1024
+
+
+def expected_records(data):
+    """the records of a capture the agent sends, skipping invalid bytes"""
+    records = []
+    pos = 0
+    while pos + 3 <= len(data):
+        kind = data[pos]
+        length = 3 + ((data[pos + 1] << 8) | data[pos + 2])
+        if kind == 1:
+            valid = length == HT20_LEN
+        elif kind == 2:
+            valid = length == HT20_40_LEN
+        elif kind == 3:
+            valid = ATH10K_HDR_LEN < length <= ATH10K_HDR_LEN + ATH10K_MAX_BINS
+        else:
+            valid = False
+
+        if not valid:
+            pos += 1
+            continue
+        if pos + length > len(data):
+            break
+
+        records.append(data[pos:pos + length])
+        pos += length
+
+    return b''.join(records), len(records)
+
+
+def read_full(sock, length):
+    buf = bytearray()
+    while len(buf) < length:
+        chunk = sock.recv(length - len(buf))
+        if not chunk:
+            return None
+        buf += chunk
+    return bytes(buf)
+
+
+def receive(path):
+    """the TLVs of all frames sent to a client, until the agent closes"""
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    for _ in range(100):
+        try:
+            sock.connect(path)
+            break
+        except (FileNotFoundError, ConnectionRefusedError):
+            time.sleep(0.05)
+    else:
+        raise RuntimeError('agent not listening on ' + path)
+
+    tlvs = bytearray()
+    frames = records = compressed = 0
+    expected_seq = 0
+    while True:
+        hdr = read_full(sock, HDR.size)
+        if hdr is None:
+            break
+
+        magic, version, flags, num, seq, raw_len, length = HDR.unpack(hdr)
+        if magic != SCAN_FRAME_MAGIC or version != SCAN_FRAME_VERSION:
+            raise RuntimeError('bad frame header')
+        if length > SCAN_FRAME_MAX_LEN or raw_len > SCAN_FRAME_MAX_LEN:
+            raise RuntimeError('frame too large')
+        if seq != expected_seq:
+            raise RuntimeError('frame %d lost from a capture' % expected_seq)
+        expected_seq = seq + 1
+
+        payload = read_full(sock, length)
+        if payload is None:
+            raise RuntimeError('truncated frame')
+
+        if flags & SCAN_FRAME_COMPRESSED:
+            # the format of qCompress(): big endian length, zlib stream
+            if length < 4 or struct.unpack('>I', payload[:4])[0] != raw_len:
+                raise RuntimeError('bad length prefix')
+            payload = zlib.decompress(payload[4:])
+            compressed += 1
+
+        if len(payload) != raw_len:
+            raise RuntimeError('payload of %d bytes, expected %d'
+                               % (len(payload), raw_len))
+
+        tlvs += payload
+        frames += 1
+        records += num
+
+    sock.close()
+    return bytes(tlvs), frames, records, compressed
+
+
+def check(agent, capture, options):
+    with open(capture, 'rb') as f:
+        data = f.read()
+    expected, num_records = expected_records(data)
+
+    tmpdir = tempfile.mkdtemp()
+    path = os.path.join(tmpdir, 'agent.sock')
+    proc = subprocess.Popen([agent, '-i', capture, '-u', path] + options,
+                            stderr=subprocess.DEVNULL)
+    try:
+        tlvs, frames, records, compressed = receive(path)
+    finally:
+        proc.terminate()
+        proc.wait()
+        if os.path.exists(path):
+            os.unlink(path)
+        os.rmdir(tmpdir)
+
+    name = '%s %s' % (os.path.basename(capture), ' '.join(options))
+    if tlvs != expected:
+        print('FAIL %s: %d bytes received, %d expected'
+              % (name, len(tlvs), len(expected)))
+        return False
+    if records != num_records:
+        print('FAIL %s: %d records announced, %d expected'
+              % (name, records, num_records))
+        return False
+    if '-z' in options and compressed == 0:
+        print('FAIL %s: no compressed frame' % name)
+        return False
+
+    print('ok   %s: %d frames, %d records' % (name, frames, records))
+    return True
+
+
+def main():
+    if len(sys.argv) < 3:
+        print('usage: %s athAgent capture.log...' % sys.argv[0])
+        return 2
+
+    agent = sys.argv[1]
+    ok = True
+    for capture in sys.argv[2:]:
+        for options in ([], ['-z'], ['-b', '4096'], ['-b', '4096', '-z'],
+                        ['-b', '4000000']):
+            ok = check(agent, capture, options) and ok
+
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
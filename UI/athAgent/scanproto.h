@@ -0,0 +1,40 @@
+#ifndef SCANPROTO_H
+#define SCANPROTO_H
+
+#include <stdint.h>
+
+/* athAgent streaming protocol
+ *
+ * The agent sends a stream of frames, each one made of a header followed
+ * by len bytes of payload. The payload is a batch of whole fft_sample
+ * TLVs, exactly as read from the driver (multi-byte fields are big
+ * endian). When SCAN_FRAME_COMPRESSED is set, the payload is the
+ * uncompressed length (32 bit, big endian) followed by the zlib stream
+ * of the TLVs, the format of qCompress(). The sequence number of the
+ * frames is incremented for every frame, sent or dropped by the agent,
+ * so that the receiver can account for the lost frames.
+ *
+ * All the fields of the header are big endian.
+ */
+
+#define SCAN_FRAME_MAGIC        0x41544853      /* "ATHS" */
+#define SCAN_FRAME_VERSION      1
+
+#define SCAN_FRAME_COMPRESSED   0x01
+
+/* largest payload accepted by the receiver */
+#define SCAN_FRAME_MAX_LEN      (4 * 1024 * 1024)
+
+#define SCAN_AGENT_PORT         4343
+
+struct scan_frame_hdr {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t flags;
+    uint16_t records;   /* number of TLVs in the payload */
+    uint32_t seq;
+    uint32_t raw_len;   /* length of the TLVs */
+    uint32_t len;       /* length of the payload */
+} __attribute__((packed));
+
+#endif // SCANPROTO_H
@@ -4,22 +4,44 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui network
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 TARGET = athScan
 TEMPLATE = app
 
 
 SOURCES += main.cpp\
-        athscan.cpp
-
-HEADERS  += athscan.h
+        athscan.cpp \
+        scanloader.cpp \
+        panorama.cpp \
+        decoder.cpp \
+        recorder.cpp \
+        scanreplay.cpp \
+        scannet.cpp \
+        perf.cpp \
+        hud.cpp \
+        samplestore.cpp \
+        mask.cpp \
+        compare.cpp
+
+HEADERS  += athscan.h \
+        scanloader.h \
+        panorama.h \
+        decoder.h \
+        recorder.h \
+        scanreplay.h \
+        scannet.h \
+        perf.h \
+        hud.h \
+        samplestore.h \
+        mask.h \
+        compare.h
 
 FORMS    += athscan.ui
 
 
 LIBS += -L$$PWD/../qwt/lib/ -lqwt
-INCLUDEPATH += $$PWD/../qwt/src
+INCLUDEPATH += $$PWD/../qwt/src $$PWD/../athAgent
 DEPENDPATH += $$PWD/../qwt/src
@@ -1,8 +1,17 @@
 #include "athscan.h"
+#include "scanloader.h"
+#include "scanreplay.h"
+#include "scannet.h"
+#include "compare.h"
+#include "decoder.h"
+#include "recorder.h"
+#include "hud.h"
+#include "perf.h"
 #include "ui_athscan.h"
 
 #include <QFileDialog>
 #include <QFile>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QTextStream>
 #include <QtEndian>
@@ -11,6 +20,8 @@
 
 #include <qwt_plot.h>
 #include <qwt_legend.h>
+#include <qwt_trace.h>
+#include <qwt_symbol.h>
 #include <qmath.h>
 
 AthScan::AthScan(QWidget *parent) :
@@ -21,23 +32,43 @@ AthScan::AthScan(QWidget *parent) :
 
     _fft_curve = NULL;
     _fft_data = NULL;
+    _discard = false;
+    _preview_curve = NULL;
+    _mask_curve = NULL;
+    _delta_curve = NULL;
+    _flag_curve = NULL;
+    _fft_truncated = false;
+    _store_mark = 0;
+    _reader = NULL;
+    _reload_pending = false;
+    _loader = NULL;
+    _replay = NULL;
+    _net = NULL;
+    _compare = NULL;
+    _recorder = NULL;
     _min_freq = 2400;
     _max_freq = 6000;
 
     connect(ui->closeButton, SIGNAL(clicked()), this, SLOT(close()));
     connect(ui->clearButton, SIGNAL(clicked()), this, SLOT(clear()));
     connect(ui->openButton, SIGNAL(clicked()), this, SLOT(open_scan_file()));
+    connect(ui->cancelButton, SIGNAL(clicked()), this, SLOT(cancel_scan_file()));
     connect(ui->minFreqSpinBox, SIGNAL(editingFinished()),this, SLOT(scale_axis()));
     connect(ui->maxFreqSpinBox, SIGNAL(editingFinished()), this, SLOT(scale_axis()));
     connect(ui->minPwrSpinBox, SIGNAL(editingFinished()), this, SLOT(scale_axis()));
     connect(ui->maxPwrSpinBox, SIGNAL(editingFinished()), this, SLOT(scale_axis()));
 
     /* init graph parameters*/
-    _canvas = new QwtPlotCanvas();
+    _canvas = new PerfCanvas();
     _canvas->setPalette(QColor("MidnightBlue"));
     _canvas->setBorderRadius(10);
     ui->fftPlot->setCanvas(_canvas);
 
+    /* performance HUD, toggled with P */
+    _hud = new PerfHud(_canvas);
+    _hud->hide();
+    ui->fftPlot->setReplotInterval(PLOT_FRAME_INTERVAL_MS);
+
     ui->fftPlot->setAxisTitle(QwtPlot::xBottom, "Frequency [MHz]");
     ui->fftPlot->setAxisScale(QwtPlot::xBottom, _min_freq, _max_freq);
     ui->fftPlot->setAxisLabelRotation(QwtPlot::xBottom, -50.0);
@@ -79,14 +110,135 @@ AthScan::AthScan(QWidget *parent) :
     set_label(_borderH, ylabel);
     _borderH->attach(ui->fftPlot);
 
+    /* stitched view of all the loaded samples */
+    qRegisterMetaType<SpectrumPanorama>("SpectrumPanorama");
+    qRegisterMetaType<MaskViolations>("MaskViolations");
+    _panorama_data = new PanoramaData(&_panorama);
+    _panorama_curve = new QwtPlotCurve("Panorama");
+    _panorama_curve->setPen(Qt::yellow, 1);
+    _panorama_curve->setStyle(QwtPlotCurve::Lines);
+    _panorama_curve->setData(_panorama_data);
+    _panorama_curve->attach(ui->fftPlot);
+
     ui->fftPlot->insertLegend(new QwtLegend());
+
+    _progress = new QProgressBar();
+    _progress->setRange(0, 100);
+    _progress->setMaximumWidth(200);
+    _progress->hide();
+    ui->statusBar->addPermanentWidget(_progress);
+    ui->cancelButton->setEnabled(false);
 }
 
 AthScan::~AthScan()
 {
+    save_mask_report();
+    delete _reader;
+    delete _loader;
+    delete _replay;
+    delete _net;
+    delete _compare;
+    delete _recorder;
     delete ui;
 }
 
+/* the loaded samples are fed to recorder, owned by AthScan */
+void AthScan::set_recorder(TriggerRecorder *recorder)
+{
+    delete _recorder;
+    _recorder = recorder;
+}
+
+/* RAM budget of the decoded samples, see SampleStore */
+void AthScan::set_memory_budget(qint64 bytes)
+{
+    _store.set_budget(bytes);
+}
+
+/* load a spectral mask, the samples loaded afterwards are checked
+ * against it
+ */
+int AthScan::set_mask(QString file_name)
+{
+    if (_mask.load(file_name) < 0)
+        return -1;
+
+    _violations.set_mask(_mask);
+
+    if (!_mask_curve) {
+        _mask_curve = new QwtPlotCurve("Mask");
+        _mask_curve->setPen(Qt::red, 2);
+        _mask_curve->setStyle(QwtPlotCurve::Lines);
+        _mask_curve->attach(ui->fftPlot);
+    }
+    _mask_curve->setSamples(_mask.points());
+
+    update_mask_zones();
+
+    return 0;
+}
+
+/* the violations are written as CSV to file_name when the window is
+ * closed
+ */
+void AthScan::set_mask_report(QString file_name)
+{
+    _mask_report = file_name;
+}
+
+void AthScan::save_mask_report()
+{
+    if (_mask_report.isEmpty() || !_violations.is_active())
+        return;
+
+    if (_violations.write_report(_mask_report) < 0)
+        qWarning() << "error writing the mask report" << _mask_report;
+    _mask_report.clear();
+}
+
+/* highlight the ranges of contiguous violated cells, reusing the zone
+ * items. Past MASK_MAX_ZONES, the last zone covers the remaining ranges
+ */
+void AthScan::update_mask_zones()
+{
+    qint32 num_zones = 0;
+
+    for (qint32 i = _violations.first_cell(); i <= _violations.last_cell(); i++) {
+        if (!_violations.violations(i))
+            continue;
+
+        qint32 end = i;
+        while (end < _violations.last_cell() && _violations.violations(end + 1))
+            end++;
+
+        QwtInterval range(_violations.cell_freq(i), _violations.cell_freq(end + 1));
+        if (num_zones == MASK_MAX_ZONES) {
+            QwtPlotZoneItem *zone = _mask_zones[num_zones - 1];
+            range.setMinValue(zone->interval().minValue());
+            zone->setInterval(range);
+        } else {
+            if (num_zones == _mask_zones.size()) {
+                QwtPlotZoneItem *zone = new QwtPlotZoneItem();
+                zone->setItemAttribute(QwtPlotItem::Legend, false);
+                zone->setOrientation(Qt::Vertical);
+                zone->setPen(Qt::red, 0.0, Qt::DotLine);
+                zone->setBrush(QColor(255, 0, 0, 60));
+                zone->attach(ui->fftPlot);
+                _mask_zones += zone;
+            }
+            _mask_zones[num_zones++]->setInterval(range);
+        }
+
+        i = end;
+    }
+
+    while (_mask_zones.size() > num_zones) {
+        QwtPlotZoneItem *zone = _mask_zones.takeLast();
+        zone->detach();
+        delete zone;
+    }
+}
+
 void AthScan::set_label(QwtPlotMarker *marker, QString label)
 {
     QwtText text(label);
@@ -95,8 +247,52 @@ void AthScan::set_label(QwtPlotMarker *marker, QString label)
     marker->setLabel(text);
 }
 
+/* the first call starts a new trace, the second one stops it and saves
+ * it as Chrome trace event JSON
+ */
+void AthScan::toggle_trace()
+{
+    if (!QwtTrace::isEnabled()) {
+        QwtTrace::clear();
+        QwtTrace::setEnabled(true);
+        ui->statusBar->showMessage(tr("tracing, press T to stop"));
+        return;
+    }
+
+    QwtTrace::setEnabled(false);
+    ui->statusBar->clearMessage();
+
+    QString file_name = QFileDialog::getSaveFileName(this, tr("Save Trace"), "",
+                                                     tr("Trace Files (*.json)"));
+    if (file_name.isEmpty())
+        return;
+
+    if (!QwtTrace::writeChromeTrace(file_name))
+        QMessageBox::information(0, "error", "error writing trace");
+}
+
 void AthScan::keyPressEvent(QKeyEvent *event)
 {
+    if (event->key() == Qt::Key_P) {
+        _hud->setVisible(!_hud->isVisible());
+        return;
+    }
+
+    if (event->key() == Qt::Key_T) {
+        toggle_trace();
+        return;
+    }
+
+    if (event->key() == Qt::Key_C) {
+        QString file_a = QFileDialog::getOpenFileName(this, tr("Open Capture A"), "", tr(""));
+        if (file_a.isEmpty())
+            return;
+        QString file_b = QFileDialog::getOpenFileName(this, tr("Open Capture B"), "", tr(""));
+        if (!file_b.isEmpty())
+            start_compare(file_a, file_b);
+        return;
+    }
+
     if (event->key() == Qt::Key_Up ||
         event->key() == Qt::Key_Down) {
         QString ylabel;
@@ -116,233 +312,605 @@ void AthScan::keyPressEvent(QKeyEvent *event)
         set_label(_borderV, xlabel);
         _borderV->setValue(value);
     }
-    ui->fftPlot->replot();
+    ui->fftPlot->scheduleReplot();
 }
 
-int AthScan::parse_scan_file(QString file_name)
+int AthScan::scale_axis()
 {
-    quint32 min_freq = ~0, max_freq = 0;
-    qint32 i = 0;
-    QFile scan_file(file_name);
+    qint32 minFreq = ui->minFreqSpinBox->value();
+    qint32 maxFreq = (minFreq > ui->maxFreqSpinBox->value()) ?  minFreq + 20 : ui->maxFreqSpinBox->value();
+    qint32 minPwr = ui->minPwrSpinBox->value();
+    qint32 maxPwr = (minPwr > ui->maxPwrSpinBox->value()) ?  minPwr + 2 : ui->maxPwrSpinBox->value();
+    quint32 x_border = (minFreq + maxFreq) / 2;
+    qint32 y_border = (minPwr + maxPwr) / 2;
+
+    _borderV->setValue(x_border, y_border);
+    QString xlabel;
+    xlabel.sprintf("%dMHz", x_border);
+    set_label(_borderV, xlabel);
+    _borderH->setValue(x_border, y_border);
+    QString ylabel;
+    ylabel.sprintf("%ddb", y_border);
+    set_label(_borderH, ylabel);
+
+    ui->fftPlot->setAxisScale(QwtPlot::xBottom, minFreq, maxFreq);
+    ui->fftPlot->setAxisScale(QwtPlot::yLeft, minPwr, maxPwr, 4);
+    reload_fft_curve(minFreq, maxFreq);
 
-    if (!scan_file.open(QIODevice::ReadOnly))
+    ui->fftPlot->scheduleReplot();
+
+    return 0;
+}
+
+/* the bin powers are computed by the decoder registered for the TLV
+ * type, see decoder.cpp
+ */
+int AthScan::compute_bin_pwr(fft_sample_tlv *tlv, QPolygonF &sample)
+{
+    const tlv_decoder *decoder = tlv_decoder_lookup(tlv->type);
+    if (!decoder)
         return -1;
 
-    QByteArray buffer = scan_file.readAll();
+    decoder->bin_pwr(tlv, sample);
 
-    scan_sample *scan_data = _fft_data;
-    while (i < buffer.size()) {
-        fft_sample_tlv *tlv = (fft_sample_tlv *)(buffer.data() + i);
-        quint8 *payload = (quint8 *)(tlv + 1);
+    return 0;
+}
 
-        if (tlv->type != ATH_FFT_SAMPLE_HT20 &&
-            tlv->type != ATH_FFT_SAMPLE_HT20_40)
-            return -1;
+int AthScan::draw_spectrum(quint32 min_freq, quint32 max_freq)
+{
+    if (_fft_truncated)
+        reload_fft_curve(min_freq, max_freq);
 
-        quint32 len = sizeof (fft_sample_tlv) + qFromBigEndian(tlv->length);
-        if (len != sizeof(fft_sample_ht20) &&
-            len != sizeof(fft_sample_ht20_40))
-            return -1;
+    ui->minFreqSpinBox->setValue(min_freq);
+    ui->maxFreqSpinBox->setValue(max_freq);
 
-        scan_sample *data = new(scan_sample);
-        if (!data)
-            continue;
-        data->next = NULL;
-        data->data = new(quint8[len]);
-        if (!data->data)
-            continue;
+    _borderV->setValue((min_freq + max_freq) / 2, (ui->minPwrSpinBox->value() + ui->maxPwrSpinBox->value()) / 2);
+    _borderH->setValue((min_freq + max_freq) / 2, (ui->minPwrSpinBox->value() + ui->maxPwrSpinBox->value()) / 2);
+
+    ui->fftPlot->setAxisScale(QwtPlot::xBottom, min_freq, max_freq);
 
-        memcpy(data->data, tlv, len);
-        quint16 freq = qFromBigEndian(*(quint16 *)(payload + 1));
+    ui->fftPlot->scheduleReplot();
+
+    return 0;
+}
 
-        if (tlv->type == ATH_FFT_SAMPLE_HT20_40) {
-            fft_sample_ht20_40 *fft_data, *sample;
+/* the coarse subsample is drawn by a dedicated curve, removed as soon
+ * as the full pass is over
+ */
+void AthScan::load_preview(QPolygonF samples, int min_freq, int max_freq)
+{
+    /* queued before clear() */
+    if (_discard)
+        return;
+
+    _preview_curve = new QwtPlotCurve();
+    _preview_curve->setItemAttribute(QwtPlotItem::Legend, false);
+    _preview_curve->setPen(Qt::green, 2);
+    _preview_curve->setStyle(QwtPlotCurve::Dots);
+    _preview_curve->setSamples(samples);
+    _preview_curve->attach(ui->fftPlot);
+
+    draw_spectrum(min_freq, max_freq);
+}
 
-            fft_data = (fft_sample_ht20_40 *) data->data;
-            sample = (fft_sample_ht20_40 *) tlv;
+void AthScan::load_samples(QPolygonF samples)
+{
+    perf_stats()->queued.deref();
+
+    /* batches queued before clear() */
+    if (_discard || !_fft_curve)
+        return;
+
+    {
+        QWT_TRACE_SCOPE_ARG("series build", "athscan", "points", samples.size());
+
+        /* the curve owns the chunked data, appending never copies the
+         * bins already drawn
+         */
+        _fft_data->append(samples.constData(), samples.size());
+
+        /* drop the oldest quarter at once to keep the removal amortized,
+         * they are still available from the store
+         */
+        if ((qint64) _fft_data->size() > PLOT_MAX_POINTS) {
+            qint32 excess = (qint32) _fft_data->size() - PLOT_MAX_POINTS * 3 / 4;
+            _fft_data->removeChunks((excess + PLOT_CHUNK_POINTS - 1) / PLOT_CHUNK_POINTS);
+            _fft_truncated = true;
+        }
 
-            fft_data->freq = freq;
+        _fft_curve->itemChanged();
+    }
 
-            fft_data->lower_max_magnitude = qFromBigEndian(sample->lower_max_magnitude);
-            fft_data->upper_max_magnitude = qFromBigEndian(sample->upper_max_magnitude);
-        } else {
-            fft_sample_ht20 *fft_data, *sample;
+    ui->fftPlot->scheduleReplot();
+}
 
-            fft_data = (fft_sample_ht20 *) data->data;
-            sample = (fft_sample_ht20 *) tlv;
+/* violations of the last batch of a source */
+void AthScan::load_mask(MaskViolations violations)
+{
+    if (_discard)
+        return;
+
+    _violations.merge(violations);
+    if (violations.is_empty())
+        return;
 
-            fft_data->freq = freq;
+    update_mask_zones();
 
-            fft_data->max_magnitude = qFromBigEndian(sample->max_magnitude);
+    float worst = 0.0, worst_freq = 0.0;
+    for (qint32 i = _violations.first_cell(); i <= _violations.last_cell(); i++) {
+        if (_violations.worst_margin(i) > worst) {
+            worst = _violations.worst_margin(i);
+            worst_freq = _violations.cell_freq(i);
         }
+    }
+
+    ui->statusBar->showMessage(tr("mask: %1 of %2 samples over the limit, worst +%3 db at %4 MHz")
+                               .arg(_violations.violating_records())
+                               .arg(_violations.records())
+                               .arg(worst, 0, 'f', 1).arg(worst_freq, 0, 'f', 1));
+    ui->fftPlot->scheduleReplot();
+}
+
+/* cells modified by the last batch of the loader */
+void AthScan::load_panorama(SpectrumPanorama panorama)
+{
+    if (_discard)
+        return;
+
+    _panorama.merge(panorama);
+    _panorama_data->invalidate();
+
+    ui->fftPlot->scheduleReplot();
+}
+
+/* once the curve has been truncated, its bins are rebuilt from the store
+ * for the frequency range of the view. The segments needed are paged back
+ * by a StoreReader, a range requested meanwhile is queried once it is over
+ */
+void AthScan::reload_fft_curve(quint32 min_freq, quint32 max_freq)
+{
+    if (!_fft_curve || !_fft_truncated)
+        return;
+
+    _reload_min_freq = min_freq;
+    _reload_max_freq = max_freq;
+    _reload_pending = (_reader != NULL);
+    if (_reader)
+        return;
+
+    store_query query;
+    query.first_segment = _store_mark;
+    query.min_freq = min_freq;
+    query.max_freq = max_freq;
+    query.min_tsf = 0;
+    query.max_tsf = ~0ULL;
+
+    _reader = new StoreReader(&_store, query, PLOT_MAX_POINTS, this);
+    connect(_reader, SIGNAL(finished()), this, SLOT(reload_finished()));
+    _reader->start();
+}
+
+/* the bins of a reader cancelled by clear() or drop_fft_curve() belong to
+ * a curve no longer shown
+ */
+void AthScan::reload_finished()
+{
+    if (_reader->error() < 0) {
+        ui->statusBar->showMessage(tr("error reading the sample store"));
+    } else if (!_reader->cancelled() && _fft_curve) {
+        QPolygonF bins = _reader->bins();
+
+        _fft_data->clear();
+        _fft_data->append(bins.constData(), bins.size());
+        _fft_curve->itemChanged();
+        ui->fftPlot->scheduleReplot();
+    }
 
-        /* compute boundaries */
-        if (freq < min_freq)
-            min_freq = freq;
-        else if (freq > max_freq)
-            max_freq = freq;
+    _reader->deleteLater();
+    _reader = NULL;
 
-        if (scan_data)
-            scan_data->next = data;
-        else
-            _fft_data = data;
-        scan_data = data;
+    if (_reload_pending) {
+        _reload_pending = false;
+        reload_fft_curve(_reload_min_freq, _reload_max_freq);
+    }
+}
 
-        i += len;
+void AthScan::load_finished()
+{
+    if (_preview_curve) {
+        _preview_curve->detach();
+        delete _preview_curve;
+        _preview_curve = NULL;
     }
 
-    scan_file.close();
+    if (_loader->error() < 0) {
+        drop_fft_curve();
+        if (!_loader->cancelled())
+            QMessageBox::information(0,"error","error parsing fft data");
+    } else {
+        if (_recorder)
+            ui->statusBar->showMessage(tr("%1 trigger events recorded")
+                                       .arg(_recorder->events()));
+
+        /* nothing to scale to for an empty capture */
+        if (_loader->min_freq() <= _loader->max_freq()) {
+            _min_freq = _loader->min_freq() - 40;
+            _max_freq = _loader->max_freq() + 40;
+        }
+        draw_spectrum(_min_freq, _max_freq);
+    }
 
-    _min_freq = min_freq - 40;
-    _max_freq = max_freq + 40;
+    _loader->deleteLater();
+    _loader = NULL;
 
-    return 0;
+    if (_recorder && _recorder->error() < 0)
+        QMessageBox::information(0, "error", "error writing the triggered capture");
+    if (_store.error() < 0)
+        QMessageBox::information(0, "error", "error spilling the samples to disk");
+
+    _progress->hide();
+    ui->cancelButton->setEnabled(false);
+    ui->openButton->setEnabled(true);
 }
 
-int AthScan::scale_axis()
+/* the records of the new source start a new segment of the store */
+void AthScan::create_fft_curve(QString title)
 {
-    qint32 minFreq = ui->minFreqSpinBox->value();
-    qint32 maxFreq = (minFreq > ui->maxFreqSpinBox->value()) ?  minFreq + 20 : ui->maxFreqSpinBox->value();
-    qint32 minPwr = ui->minPwrSpinBox->value();
-    qint32 maxPwr = (minPwr > ui->maxPwrSpinBox->value()) ?  minPwr + 2 : ui->maxPwrSpinBox->value();
-    quint32 x_border = (minFreq + maxFreq) / 2;
-    qint32 y_border = (minPwr + maxPwr) / 2;
+    _fft_truncated = false;
+    _discard = false;
+    _store_mark = _store.seal();
+    _fft_data = new QwtChunkedPointData(PLOT_CHUNK_POINTS);
+    _fft_curve = new QwtPlotCurve();
+    _fft_curve->setData(_fft_data);
+    _fft_curve->setTitle(title);
+    _fft_curve->setPen(Qt::green, 2);
+    _fft_curve->setStyle(QwtPlotCurve::Dots);
+    _fft_curve->attach(ui->fftPlot);
+}
 
-    _borderV->setValue(x_border, y_border);
-    QString xlabel;
-    xlabel.sprintf("%dMHz", x_border);
-    set_label(_borderV, xlabel);
-    _borderH->setValue(x_border, y_border);
-    QString ylabel;
-    ylabel.sprintf("%ddb", y_border);
-    set_label(_borderH, ylabel);
+/* the records of a failed or cancelled source are dropped from the store */
+void AthScan::drop_fft_curve()
+{
+    if (_fft_curve) {
+        _fft_curve->detach();
+        delete _fft_curve;
+        _fft_curve = NULL;
+        _fft_data = NULL;
+    }
+    if (_reader)
+        _reader->cancel();
+    _reload_pending = false;
+    _store.truncate(_store_mark);
+    ui->fftPlot->scheduleReplot();
+}
 
-    ui->fftPlot->setAxisScale(QwtPlot::xBottom, minFreq, maxFreq);
-    ui->fftPlot->setAxisScale(QwtPlot::yLeft, minPwr, maxPwr, 4);
+/* replay a capture as a live source, paced on the TSF of the records
+ * scaled by speed, or as fast as possible with firehose
+ */
+int AthScan::start_replay(QString file, double speed, bool firehose)
+{
+    if (_loader || _replay || _net || _compare)
+        return -1;
 
-    ui->fftPlot->replot();
+    create_fft_curve(QFileInfo(file).fileName());
+
+    _replay = new ScanReplay(file, this);
+    _replay->set_speed(speed);
+    _replay->set_firehose(firehose);
+    _replay->set_recorder(_recorder);
+    _replay->set_store(&_store);
+    _replay->set_mask(_mask);
+    connect(_replay, SIGNAL(samples_ready(QPolygonF, qint64)),
+            this, SLOT(replay_samples(QPolygonF, qint64)));
+    connect(_replay, SIGNAL(panorama_ready(SpectrumPanorama)),
+            this, SLOT(load_panorama(SpectrumPanorama)));
+    connect(_replay, SIGNAL(mask_ready(MaskViolations)),
+            this, SLOT(load_mask(MaskViolations)));
+    connect(_replay, SIGNAL(statistics(double, double, qint64, double)),
+            this, SLOT(replay_statistics(double, double, qint64, double)));
+    connect(_replay, SIGNAL(finished()), this, SLOT(replay_finished()));
+
+    ui->openButton->setEnabled(false);
+    ui->cancelButton->setEnabled(true);
+    draw_spectrum(_min_freq, _max_freq);
+
+    _replay->start();
 
     return 0;
 }
 
-int AthScan::compute_bin_pwr(fft_sample_tlv *tlv, QPolygonF &sample)
+void AthScan::replay_samples(QPolygonF samples, qint64 stamp)
 {
-    if (tlv->type == ATH_FFT_SAMPLE_HT20_40) {
-        quint32 lower_datasquaresum = 0, upper_datasquaresum = 0;
-        fft_sample_ht20_40 *fft_data = (fft_sample_ht20_40 *) tlv;
-
-        for (qint32 i = 0; i < DELTA; i++) {
-            qint32 lower_data = fft_data->data[i] << fft_data->max_exp;
-            qint32 upper_data = fft_data->data[i + DELTA] << fft_data->max_exp;
-            lower_data *= lower_data;
-            upper_data *= upper_data;
-            lower_datasquaresum += lower_data;
-            upper_datasquaresum += upper_data;
-        }
+    load_samples(samples);
+    _replay->consumed(stamp);
+}
 
-        for (qint32 i = 0; i < DELTA; i++) {
-            float lower_freq, upper_freq;
-            if (fft_data->channel_type == NL80211_CHAN_HT40PLUS) {
-                lower_freq = fft_data->freq - 10.0 + ((20.0 * i) / DELTA);
-                upper_freq = fft_data->freq + 10.0 + ((20.0 * i) / DELTA);
-            } else {
-                lower_freq = fft_data->freq - 30.0 + ((20.0 * i) / DELTA);
-                upper_freq = fft_data->freq - 10.0 + ((20.0 * i) / DELTA);
-            }
-            qint32 lower_data = fft_data->data[i] << fft_data->max_exp;
-            if (lower_data == 0)
-                lower_data = 1;
-            qint32 upper_data = fft_data->data[i + DELTA] << fft_data->max_exp;
-            if (upper_data == 0)
-                upper_data = 1;
-            float lower_pwr = fft_data->lower_noise + fft_data->lower_rssi +
-                              20 * log10f(lower_data) - log10f(lower_datasquaresum) * 10;
-            sample += QPointF(lower_freq, lower_pwr);
-            float upper_pwr = fft_data->upper_noise + fft_data->upper_rssi +
-                              20 * log10f(upper_data) - log10f(upper_datasquaresum) * 10;
-            sample += QPointF(upper_freq, upper_pwr);
-        }
-    } else {
-        quint32 datasquaresum = 0;
-        fft_sample_ht20 *fft_data = (fft_sample_ht20 *) tlv;
-        for (qint32 i = 0; i < SPECTRAL_HT20_NUM_BINS; i++) {
-            qint32 data = fft_data->data[i] << fft_data->max_exp;
-            data *= data;
-            datasquaresum += data;
-        }
+void AthScan::replay_statistics(double target_rate, double achieved_rate,
+                                qint64 dropped, double latency_ms)
+{
+    QString target = (target_rate > 0.0)
+                     ? QString::number(target_rate, 'f', 0) : tr("unlimited");
 
-        for (qint32 i = 0; i < SPECTRAL_HT20_NUM_BINS; i++) {
-            float freq = fft_data->freq - 10.0 + ((20.0 * i) / SPECTRAL_HT20_NUM_BINS);
-            qint32 data = fft_data->data[i] << fft_data->max_exp;
-            if (data == 0)
-                data = 1;
-            float pwr = fft_data->noise + fft_data->rssi + 20 * log10f(data) - log10f(datasquaresum) * 10;
-            sample += QPointF(freq, pwr);
-        }
+    ui->statusBar->showMessage(tr("replay: %1 bins/s (target %2), %3 dropped, latency %4 ms")
+                               .arg(achieved_rate, 0, 'f', 0).arg(target)
+                               .arg(dropped).arg(latency_ms, 0, 'f', 1));
+}
+
+void AthScan::replay_finished()
+{
+    if (_replay->error() < 0 || _replay->cancelled()) {
+        drop_fft_curve();
+        if (!_replay->cancelled())
+            QMessageBox::information(0, "error", "error replaying fft data");
     }
 
+    if (_store.error() < 0)
+        QMessageBox::information(0, "error", "error spilling the samples to disk");
+
+    _replay->deleteLater();
+    _replay = NULL;
+
+    ui->cancelButton->setEnabled(false);
+    ui->openButton->setEnabled(true);
+}
+
+/* receive the samples streamed by athAgent at address, host[:port] or
+ * unix:path
+ */
+int AthScan::start_network(QString address)
+{
+    if (_loader || _replay || _net || _compare)
+        return -1;
+
+    create_fft_curve(address);
+
+    _net = new ScanNetSource(address, this);
+    _net->set_recorder(_recorder);
+    _net->set_store(&_store);
+    _net->set_mask(_mask);
+    connect(_net, SIGNAL(samples_ready(QPolygonF)),
+            this, SLOT(load_samples(QPolygonF)));
+    connect(_net, SIGNAL(panorama_ready(SpectrumPanorama)),
+            this, SLOT(load_panorama(SpectrumPanorama)));
+    connect(_net, SIGNAL(mask_ready(MaskViolations)),
+            this, SLOT(load_mask(MaskViolations)));
+    connect(_net, SIGNAL(statistics(qint64, qint64, double, double)),
+            this, SLOT(network_statistics(qint64, qint64, double, double)));
+    connect(_net, SIGNAL(finished()), this, SLOT(network_finished()));
+
+    ui->openButton->setEnabled(false);
+    ui->cancelButton->setEnabled(true);
+    draw_spectrum(_min_freq, _max_freq);
+
+    _net->start();
+
     return 0;
 }
 
-int AthScan::draw_spectrum(quint32 min_freq, quint32 max_freq)
+void AthScan::network_statistics(qint64 records, qint64 lost_frames,
+                                 double record_rate, double byte_rate)
 {
-    QPolygonF fft_samples;
+    ui->statusBar->showMessage(tr("network: %1 samples (%2/s, %3 kB/s), %4 frames lost")
+                               .arg(records).arg(record_rate, 0, 'f', 0)
+                               .arg(byte_rate / 1024, 0, 'f', 0).arg(lost_frames));
+}
 
-    _fft_curve = new QwtPlotCurve();
-    _fft_curve->setTitle(_label);
-    _fft_curve->setPen(Qt::green, 2);
-    _fft_curve->setStyle(QwtPlotCurve::Dots);
+void AthScan::network_finished()
+{
+    if (_net->error() < 0 || _net->cancelled()) {
+        drop_fft_curve();
+        if (!_net->cancelled())
+            QMessageBox::information(0, "error", "error receiving fft data");
+    }
 
-    ui->minFreqSpinBox->setValue(min_freq);
-    ui->maxFreqSpinBox->setValue(max_freq);
+    if (_store.error() < 0)
+        QMessageBox::information(0, "error", "error spilling the samples to disk");
 
-    for (scan_sample *data = _fft_data; data; data = data->next)
-        compute_bin_pwr((fft_sample_tlv *) data->data, fft_samples);
+    _net->deleteLater();
+    _net = NULL;
 
-    _fft_curve->setSamples(fft_samples);
-    _fft_curve->attach(ui->fftPlot);
+    ui->cancelButton->setEnabled(false);
+    ui->openButton->setEnabled(true);
+}
 
-    _borderV->setValue((min_freq + max_freq) / 2, (ui->minPwrSpinBox->value() + ui->maxPwrSpinBox->value()) / 2);
-    _borderH->setValue((min_freq + max_freq) / 2, (ui->minPwrSpinBox->value() + ui->maxPwrSpinBox->value()) / 2);
+/* compare two captures streamed through their statistics. The delta of
+ * the mean power B - A is drawn on the right axis, the cells with a
+ * significant delta are flagged
+ */
+int AthScan::start_compare(QString file_a, QString file_b)
+{
+    if (_loader || _replay || _net || _compare)
+        return -1;
 
-    ui->fftPlot->setAxisScale(QwtPlot::xBottom, min_freq, max_freq);
+    clear_compare();
 
-    ui->fftPlot->replot();
+    _compare = new ScanCompare(file_a, file_b, this);
+    connect(_compare, SIGNAL(progress(int)), _progress, SLOT(setValue(int)));
+    connect(_compare, SIGNAL(finished()), this, SLOT(compare_finished()));
+
+    _progress->setValue(0);
+    _progress->show();
+    ui->openButton->setEnabled(false);
+    ui->cancelButton->setEnabled(true);
+    ui->statusBar->showMessage(tr("comparing %1 and %2")
+                               .arg(QFileInfo(file_a).fileName())
+                               .arg(QFileInfo(file_b).fileName()));
+
+    _compare->start();
 
     return 0;
 }
 
+void AthScan::compare_finished()
+{
+    if (_compare->error() < 0) {
+        if (!_compare->cancelled())
+            QMessageBox::information(0, "error", "error comparing the captures");
+        ui->statusBar->clearMessage();
+    } else {
+        const QVector<compare_cell> cells = _compare->results();
+        QPolygonF delta, flags;
+        float largest = 0.0, largest_freq = 0.0;
+
+        for (qint32 i = 0; i < cells.size(); i++) {
+            const compare_cell &cell = cells[i];
+
+            delta += QPointF(cell.freq, cell.delta_pwr);
+            if (!cell.significant)
+                continue;
+
+            flags += QPointF(cell.freq, cell.delta_pwr);
+            if (qAbs(cell.delta_pwr) > qAbs(largest)) {
+                largest = cell.delta_pwr;
+                largest_freq = cell.freq;
+            }
+        }
+
+        _delta_curve = new QwtPlotCurve("B - A");
+        _delta_curve->setPen(Qt::cyan, 1);
+        _delta_curve->setStyle(QwtPlotCurve::Lines);
+        _delta_curve->setYAxis(QwtPlot::yRight);
+        _delta_curve->setSamples(delta);
+        _delta_curve->attach(ui->fftPlot);
+
+        _flag_curve = new QwtPlotCurve("Significant");
+        _flag_curve->setStyle(QwtPlotCurve::NoCurve);
+        _flag_curve->setSymbol(new QwtSymbol(QwtSymbol::Ellipse, QBrush(Qt::magenta),
+                                             QPen(Qt::magenta), QSize(7, 7)));
+        _flag_curve->setYAxis(QwtPlot::yRight);
+        _flag_curve->setSamples(flags);
+        _flag_curve->attach(ui->fftPlot);
+
+        ui->fftPlot->setAxisTitle(QwtPlot::yRight, "Delta [db]");
+        ui->fftPlot->enableAxis(QwtPlot::yRight);
+
+        ui->statusBar->showMessage(tr("compare: %1 of %2 cells differ, largest delta %3 db at %4 MHz")
+                                   .arg(flags.size()).arg(cells.size())
+                                   .arg(largest, 0, 'f', 1).arg(largest_freq, 0, 'f', 1));
+
+        if (!cells.isEmpty())
+            draw_spectrum((quint32) cells.first().freq - 10, (quint32) cells.last().freq + 10);
+    }
+
+    _compare->deleteLater();
+    _compare = NULL;
+
+    _progress->hide();
+    ui->cancelButton->setEnabled(false);
+    ui->openButton->setEnabled(true);
+}
+
+void AthScan::clear_compare()
+{
+    if (_delta_curve) {
+        _delta_curve->detach();
+        delete _delta_curve;
+        _delta_curve = NULL;
+    }
+    if (_flag_curve) {
+        _flag_curve->detach();
+        delete _flag_curve;
+        _flag_curve = NULL;
+    }
+    ui->fftPlot->enableAxis(QwtPlot::yRight, false);
+}
+
 int AthScan::open_scan_file()
 {
+    if (_loader || _replay || _net || _compare)
+        return -1;
+
     QString file = QFileDialog::getOpenFileName(this, tr("Open File"), "", tr(""));
     if (!file.isEmpty()) {
-        if (parse_scan_file(file) < 0) {
-            QMessageBox::information(0,"error","error parsing fft data");
-            return -1;
-        }
         _label = QFileInfo(file).fileName();
         qint32 idx = _label.lastIndexOf(".");
         if (idx >= 0)
             _label.chop(_label.size() - idx);
-        draw_spectrum(_min_freq, _max_freq);
+
+        create_fft_curve(_label);
+
+        _loader = new ScanLoader(file, this);
+        _loader->set_recorder(_recorder);
+        _loader->set_store(&_store);
+        _loader->set_mask(_mask);
+        connect(_loader, SIGNAL(progress(int)), _progress, SLOT(setValue(int)));
+        connect(_loader, SIGNAL(preview_ready(QPolygonF, int, int)),
+                this, SLOT(load_preview(QPolygonF, int, int)));
+        connect(_loader, SIGNAL(samples_ready(QPolygonF)),
+                this, SLOT(load_samples(QPolygonF)));
+        connect(_loader, SIGNAL(panorama_ready(SpectrumPanorama)),
+                this, SLOT(load_panorama(SpectrumPanorama)));
+        connect(_loader, SIGNAL(mask_ready(MaskViolations)),
+                this, SLOT(load_mask(MaskViolations)));
+        connect(_loader, SIGNAL(finished()), this, SLOT(load_finished()));
+
+        _progress->setValue(0);
+        _progress->show();
+        ui->openButton->setEnabled(false);
+        ui->cancelButton->setEnabled(true);
+
+        _loader->start();
     }
     return 0;
 }
 
+int AthScan::cancel_scan_file()
+{
+    if (_loader)
+        _loader->cancel();
+    if (_replay)
+        _replay->cancel();
+    if (_net)
+        _net->cancel();
+    if (_compare)
+        _compare->cancel();
+
+    return 0;
+}
+
 int AthScan::clear()
 {
+    /* drop the pending load, its data are freed in load_finished().
+     * The batches it already queued are discarded until then
+     */
+    if (_loader || _replay || _net)
+        _discard = true;
+    if (_loader)
+        _loader->cancel();
+    if (_replay)
+        _replay->cancel();
+    if (_net)
+        _net->cancel();
+    if (_compare)
+        _compare->cancel();
+    if (_reader)
+        _reader->cancel();
+    _reload_pending = false;
+
     _min_freq = 2400;
     _max_freq = 6000;
 
-    while (_fft_data) {
-        struct scan_sample *fft_ptr = _fft_data;
-        _fft_data = _fft_data->next;
-        free(fft_ptr->data);
-        free(fft_ptr);
+    /* records still appended by a cancelled loader are dropped with
+     * the mark in load_finished()
+     */
+    _store.clear();
+    _store_mark = 0;
+    _fft_truncated = false;
+    drop_fft_curve();
+
+    if (_preview_curve) {
+        _preview_curve->detach();
+        delete _preview_curve;
+        _preview_curve = NULL;
     }
 
-    if (_fft_curve)
-        _fft_curve->detach();
+    _panorama.clear();
+    _panorama_data->invalidate();
+
+    _violations.clear();
+    update_mask_zones();
+
+    clear_compare();
 
     ui->minFreqSpinBox->setValue(_min_freq);
     ui->maxFreqSpinBox->setValue(_max_freq);
@@ -354,6 +922,7 @@ int AthScan::clear()
 
 int AthScan::close()
 {
+    save_mask_report();
     clear();
     qApp->exit();
 
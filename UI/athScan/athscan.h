@@ -4,19 +4,43 @@
 #include <stdint.h>
 
 #include <QMainWindow>
+#include <QProgressBar>
 #include <qwt_plot_canvas.h>
 #include <qwt_plot_grid.h>
 #include <qwt_plot_marker.h>
 #include <qwt_plot_curve.h>
+#include <qwt_plot_zoneitem.h>
+#include <qwt_point_data.h>
+
+#include "panorama.h"
+#include "samplestore.h"
+#include "mask.h"
 
 namespace Ui {
 class AthScan;
 }
 
+class ScanLoader;
+class ScanReplay;
+class ScanNetSource;
+class ScanCompare;
+class PanoramaData;
+class TriggerRecorder;
+class PerfHud;
+
 #define SPECTRAL_HT20_NUM_BINS      56
 #define SPECTRAL_HT20_40_NUM_BINS   128
 #define DELTA   (SPECTRAL_HT20_40_NUM_BINS / 2)
 
+/* minimum interval between two redraws of the spectrum plot */
+#define PLOT_FRAME_INTERVAL_MS  20
+/* largest number of bins drawn by the fft curve, older bins are left to
+ * the sample store
+ */
+#define PLOT_MAX_POINTS         (4 * 1024 * 1024)
+/* bins held by a chunk of the fft curve data */
+#define PLOT_CHUNK_POINTS       (64 * 1024)
+
 /* ath9k data structure, please see
  * drivers/net/wireless/ath/ath9k/ath9k.h
  */
@@ -29,7 +53,8 @@ enum nl80211_channel_type {
 
 enum ath_fft_sample_type {
     ATH_FFT_SAMPLE_HT20 = 1,
-    ATH_FFT_SAMPLE_HT20_40
+    ATH_FFT_SAMPLE_HT20_40,
+    ATH_FFT_SAMPLE_ATH10K
 };
 
 struct fft_sample_tlv {
@@ -83,10 +108,28 @@ struct fft_sample_ht20_40 {
     uint8_t data[SPECTRAL_HT20_40_NUM_BINS];
 } __attribute__((packed));
 
-struct scan_sample {
-    uint8_t *data;
-    struct scan_sample *next;
-};
+/* ath10k data structure, please see
+ * drivers/net/wireless/ath/spectral_common.h
+ */
+struct fft_sample_ath10k {
+    struct fft_sample_tlv tlv;
+
+    uint8_t chan_width_mhz;
+    uint16_t freq1;
+    uint16_t freq2;
+    int16_t noise;
+    uint16_t max_magnitude;
+    uint16_t total_gain_db;
+    uint16_t base_pwr_db;
+    uint64_t tsf;
+    int8_t max_index;
+    uint8_t rssi;
+    uint8_t relpwr_db;
+    uint8_t avgpwr_db;
+    uint8_t max_exp;
+
+    uint8_t data[0];
+} __attribute__((packed));
 
 class AthScan : public QMainWindow
 {
@@ -96,26 +139,74 @@ public:
     explicit AthScan(QWidget *parent = 0);
     ~AthScan();
 
+    static int compute_bin_pwr(fft_sample_tlv *, QPolygonF&);
+    void set_recorder(TriggerRecorder *);
+    void set_memory_budget(qint64);
+    int start_replay(QString, double, bool);
+    int start_network(QString);
+    int set_mask(QString);
+    void set_mask_report(QString);
+    int start_compare(QString, QString);
+
 private slots:
     int clear();
     int close();
     int open_scan_file();
+    int cancel_scan_file();
     int scale_axis();
+    void load_preview(QPolygonF, int, int);
+    void load_samples(QPolygonF);
+    void load_panorama(SpectrumPanorama);
+    void load_mask(MaskViolations);
+    void load_finished();
+    void replay_samples(QPolygonF, qint64);
+    void replay_statistics(double, double, qint64, double);
+    void replay_finished();
+    void network_statistics(qint64, qint64, double, double);
+    void network_finished();
+    void compare_finished();
+    void reload_finished();
 
 private:
-    int parse_scan_file(QString);
     int draw_spectrum(quint32, quint32);
-    int compute_bin_pwr(fft_sample_tlv *, QPolygonF&);
+    void create_fft_curve(QString);
+    void drop_fft_curve();
+    void reload_fft_curve(quint32, quint32);
+    void toggle_trace();
+    void update_mask_zones();
+    void save_mask_report();
+    void clear_compare();
     void set_label(QwtPlotMarker *, QString);
     void keyPressEvent(QKeyEvent *);
 
     QwtPlotCanvas *_canvas;
     QwtPlotGrid *_grid;
     QwtPlotMarker *_borderV, *_borderH;
-    QwtPlotCurve *_fft_curve;
+    QwtPlotCurve *_fft_curve, *_preview_curve, *_panorama_curve, *_mask_curve;
+    QwtPlotCurve *_delta_curve, *_flag_curve;
+    QList<QwtPlotZoneItem *> _mask_zones;
+    QProgressBar *_progress;
+    PerfHud *_hud;
 
     Ui::AthScan *ui;
-    struct scan_sample *_fft_data;
+    SampleStore _store;
+    qint32 _store_mark;
+    StoreReader *_reader;
+    bool _reload_pending;
+    quint32 _reload_min_freq, _reload_max_freq;
+    ScanLoader *_loader;
+    ScanReplay *_replay;
+    ScanNetSource *_net;
+    ScanCompare *_compare;
+    TriggerRecorder *_recorder;
+    QwtChunkedPointData *_fft_data;
+    bool _fft_truncated;
+    bool _discard;
+    SpectrumPanorama _panorama;
+    PanoramaData *_panorama_data;
+    SpectralMask _mask;
+    MaskViolations _violations;
+    QString _mask_report;
 
     QString _label;
     quint32 _min_freq, _max_freq;
@@ -0,0 +1,280 @@
+#include "compare.h"
+#include "decoder.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <qmath.h>
+#include <string.h>
+
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrentRun>
+#else
+#include <QtConcurrentRun>
+#endif
+
+#include <qwt_trace.h>
+
+CaptureStats::CaptureStats() :
+    _count(PANORAMA_NUM_CELLS, 0),
+    _busy(PANORAMA_NUM_CELLS, 0),
+    _pwr_sum(PANORAMA_NUM_CELLS, 0.0),
+    _hist(PANORAMA_NUM_CELLS * COMPARE_HIST_BINS, 0),
+    _first(PANORAMA_NUM_CELLS),
+    _last(-1)
+{
+}
+
+/* bins are evenly spaced and given by their lower edge, as computed by
+ * the tlv decoders
+ */
+void CaptureStats::add_bins(const QPointF *bins, qint32 num_bins)
+{
+    if (num_bins <= 0)
+        return;
+
+    float width = (num_bins > 1) ? bins[1].x() - bins[0].x() : 0.0;
+
+    for (qint32 i = 0; i < num_bins; i++) {
+        float pos = (bins[i].x() + width / 2 - PANORAMA_MIN_FREQ) / PANORAMA_CELL_WIDTH;
+        if (pos < 0.0 || pos >= PANORAMA_NUM_CELLS)
+            continue;
+
+        qint32 cell = (qint32) pos;
+        float pwr = bins[i].y();
+
+        _count[cell]++;
+        _pwr_sum[cell] += powf(10.0, pwr / 10);
+        if (pwr >= COMPARE_BUSY_PWR)
+            _busy[cell]++;
+
+        qint32 bin = qBound(0, (qint32) floorf(pwr - COMPARE_HIST_MIN_PWR),
+                            COMPARE_HIST_BINS - 1);
+        _hist[cell * COMPARE_HIST_BINS + bin]++;
+
+        if (cell < _first)
+            _first = cell;
+        if (cell > _last)
+            _last = cell;
+    }
+}
+
+void CaptureStats::clear()
+{
+    for (qint32 i = _first; i <= _last; i++) {
+        _count[i] = _busy[i] = 0;
+        _pwr_sum[i] = 0.0;
+        memset(_hist.data() + i * COMPARE_HIST_BINS, 0, COMPARE_HIST_BINS * sizeof(quint32));
+    }
+
+    _first = PANORAMA_NUM_CELLS;
+    _last = -1;
+}
+
+qint32 CaptureStats::first_cell() const
+{
+    return _first;
+}
+
+qint32 CaptureStats::last_cell() const
+{
+    return _last;
+}
+
+quint32 CaptureStats::count(qint32 cell) const
+{
+    return _count[cell];
+}
+
+/* mean of the linear power [dbm] */
+float CaptureStats::mean_pwr(qint32 cell) const
+{
+    if (!_count[cell])
+        return PANORAMA_FLOOR_PWR;
+
+    return 10 * log10(_pwr_sum[cell] / _count[cell]);
+}
+
+float CaptureStats::duty_cycle(qint32 cell) const
+{
+    if (!_count[cell])
+        return 0.0;
+
+    return (float) _busy[cell] / _count[cell];
+}
+
+const quint32 *CaptureStats::histogram(qint32 cell) const
+{
+    return _hist.constData() + cell * COMPARE_HIST_BINS;
+}
+
+ScanCompare::ScanCompare(QString file_a, QString file_b, QObject *parent) :
+    QThread(parent),
+    _cancel(0),
+    _error(0),
+    _total(0),
+    _done_kb(0)
+{
+    _file_name[0] = file_a;
+    _file_name[1] = file_b;
+}
+
+ScanCompare::~ScanCompare()
+{
+    cancel();
+    wait();
+}
+
+void ScanCompare::cancel()
+{
+    _cancel.store(1);
+}
+
+bool ScanCompare::cancelled() const
+{
+    return _cancel.load() != 0;
+}
+
+int ScanCompare::error() const
+{
+    return _error.load();
+}
+
+/* cells covered by both captures, valid once the thread is finished */
+QVector<compare_cell> ScanCompare::results() const
+{
+    return _results;
+}
+
+/* may be called from both aggregating threads */
+void ScanCompare::report(qint64 bytes)
+{
+    qint64 done_kb = _done_kb.fetchAndAddRelaxed(bytes / 1024) + bytes / 1024;
+    qint64 done = done_kb * 1024;
+
+    emit progress((int) qMin(100 * done / qMax(_total, (qint64) 1), (qint64) 100));
+}
+
+/* stream the records of a capture in its stats. An error
+ * on one side stops the other one
+ */
+int ScanCompare::aggregate(qint32 side)
+{
+    QFile scan_file(_file_name[side]);
+
+    if (!scan_file.open(QIODevice::ReadOnly)) {
+        _error.store(-1);
+        return -1;
+    }
+
+    QByteArray buffer;
+    qint64 size = scan_file.size();
+    const quint8 *data;
+    {
+        QWT_TRACE_SCOPE("file read", "athscan");
+        data = scan_file.map(0, size);
+        if (!data) {
+            buffer = scan_file.readAll();
+            data = (const quint8 *) buffer.constData();
+            size = buffer.size();
+        }
+    }
+
+    quint8 sample[SCAN_MAX_SAMPLE_LEN];
+    fft_sample_tlv *tlv = (fft_sample_tlv *) sample;
+    CaptureStats &stats = _stats[side];
+    QPolygonF bins;
+    qint64 reported = 0;
+    qint64 i = 0;
+
+    while (i < size) {
+        if (cancelled() || _error.load() < 0)
+            return -1;
+
+        qint32 len = tlv_sample_len(data + i, size - i);
+        if (len < 0) {
+            _error.store(-1);
+            return -1;
+        }
+
+        const tlv_decoder *decoder = tlv_decoder_lookup(data[i]);
+        {
+            QWT_TRACE_SCOPE("TLV parse", "athscan");
+            decoder->decode(data + i, len, sample);
+        }
+
+        bins.resize(0);
+        {
+            QWT_TRACE_SCOPE("power compute", "athscan");
+            decoder->bin_pwr(tlv, bins);
+        }
+        stats.add_bins(bins.constData(), bins.size());
+
+        i += len;
+        if (i - reported >= COMPARE_PROGRESS_BYTES) {
+            report(i - reported);
+            reported = i;
+        }
+    }
+    report(i - reported);
+
+    return 0;
+}
+
+/* differential pass over the cells covered by both captures */
+void ScanCompare::compare()
+{
+    const CaptureStats &a = _stats[0];
+    const CaptureStats &b = _stats[1];
+
+    _results.clear();
+
+    qint32 first = qMax(a.first_cell(), b.first_cell());
+    qint32 last = qMin(a.last_cell(), b.last_cell());
+    for (qint32 i = first; i <= last; i++) {
+        quint32 n = a.count(i), m = b.count(i);
+        if (!n || !m)
+            continue;
+
+        /* largest distance of the cumulative distributions */
+        const quint32 *hist_a = a.histogram(i);
+        const quint32 *hist_b = b.histogram(i);
+        quint64 cum_a = 0, cum_b = 0;
+        double distance = 0.0;
+        for (qint32 k = 0; k < COMPARE_HIST_BINS; k++) {
+            cum_a += hist_a[k];
+            cum_b += hist_b[k];
+            distance = qMax(distance, qAbs((double) cum_a / n - (double) cum_b / m));
+        }
+
+        compare_cell cell;
+        cell.freq = PANORAMA_MIN_FREQ + (i + 0.5) * PANORAMA_CELL_WIDTH;
+        cell.delta_pwr = b.mean_pwr(i) - a.mean_pwr(i);
+        cell.delta_duty = b.duty_cycle(i) - a.duty_cycle(i);
+        cell.ks_distance = distance;
+
+        double critical = COMPARE_KS_COEFF * sqrt((double) (n + m) / ((double) n * m));
+        cell.significant = distance > critical &&
+                           (qAbs(cell.delta_pwr) >= COMPARE_MIN_DELTA_PWR ||
+                            qAbs(cell.delta_duty) >= COMPARE_MIN_DELTA_DUTY);
+
+        _results += cell;
+    }
+}
+
+void ScanCompare::run()
+{
+    _total = QFileInfo(_file_name[0]).size() + QFileInfo(_file_name[1]).size();
+
+    /* A is aggregated by a pool thread while this thread does B */
+    QFuture<int> side_a = QtConcurrent::run(this, &ScanCompare::aggregate, 0);
+    int ret_b = aggregate(1);
+    int ret_a = side_a.result();
+
+    if (ret_a < 0 || ret_b < 0) {
+        _error.store(-1);
+        return;
+    }
+
+    compare();
+    emit progress(100);
+}
@@ -0,0 +1,110 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QVector>
+#include <QPolygonF>
+
+#include "panorama.h"
+
+/* power histogram of every cell, 1db per bin */
+#define COMPARE_HIST_MIN_PWR    -128
+#define COMPARE_HIST_BINS       128
+/* a bin above this power [dbm] counts as busy for the duty cycle */
+#define COMPARE_BUSY_PWR        -85.0
+/* KS coefficient for a significance level of 0.05 */
+#define COMPARE_KS_COEFF        1.358
+/* smallest deltas worth flagging, on top of the KS test */
+#define COMPARE_MIN_DELTA_PWR   3.0
+#define COMPARE_MIN_DELTA_DUTY  0.1
+/* interval between two progress reports [bytes of each capture] */
+#define COMPARE_PROGRESS_BYTES  (4 * 1024 * 1024)
+
+/* CaptureStats aggregates the bins of a capture on the panorama grid.
+ *
+ * Every bin is accounted in the cell of its center: the number of bins,
+ * the sum of their linear power, the busy bins and a power histogram.
+ * The aggregates are streamed, the bins are not kept.
+ */
+class CaptureStats
+{
+public:
+    CaptureStats();
+
+    void add_bins(const QPointF *bins, qint32 num_bins);
+    void clear();
+
+    qint32 first_cell() const;
+    qint32 last_cell() const;
+
+    quint32 count(qint32) const;
+    float mean_pwr(qint32) const;
+    float duty_cycle(qint32) const;
+    const quint32 *histogram(qint32) const;
+
+private:
+    QVector<quint32> _count, _busy;
+    QVector<double> _pwr_sum;
+    QVector<quint32> _hist;
+    qint32 _first, _last;
+};
+
+/* differential statistics of a cell, B relative to A */
+struct compare_cell {
+    float freq;             /* center of the cell [MHz] */
+    float delta_pwr;        /* delta of the mean power [db] */
+    float delta_duty;       /* delta of the duty cycle */
+    float ks_distance;      /* largest distance of the power CDFs */
+    bool significant;
+};
+
+/* ScanCompare compares two captures, A and B, cell by cell.
+ *
+ * Both captures are decoded in parallel, each one in its own thread,
+ * and aggregated by a CaptureStats, the samples are not kept. The
+ * differential pass then gives, for the cells covered by both captures,
+ * the deltas of mean power and duty cycle and the Kolmogorov-Smirnov
+ * distance of the power distributions. A delta is flagged as significant
+ * when the distance passes the KS test at the 0.05 level and the power
+ * or duty cycle delta is above COMPARE_MIN_DELTA_PWR/DUTY. The bins of a
+ * sample are not independent, so the test is a screening aid only.
+ */
+class ScanCompare : public QThread
+{
+    Q_OBJECT
+
+public:
+    ScanCompare(QString file_a, QString file_b, QObject *parent = 0);
+    ~ScanCompare();
+
+    void cancel();
+    bool cancelled() const;
+    int error() const;
+
+    QVector<compare_cell> results() const;
+
+signals:
+    void progress(int percent);
+
+protected:
+    virtual void run();
+
+private:
+    int aggregate(qint32 side);
+    void report(qint64 bytes);
+    void compare();
+
+    QString _file_name[2];
+    CaptureStats _stats[2];
+
+    QAtomicInt _cancel;
+    QAtomicInt _error;
+
+    qint64 _total;
+    QAtomicInt _done_kb;
+
+    QVector<compare_cell> _results;
+};
+
+#endif // COMPARE_H
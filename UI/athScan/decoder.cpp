@@ -0,0 +1,260 @@
+#include "decoder.h"
+
+#include <QtEndian>
+#include <qmath.h>
+#include <string.h>
+
+/* Every TLV type is handled by a specialization of fft_decoder, giving
+ * the record layout and the number of bins at compile time. Supporting a
+ * new format means adding a specialization and registering it in
+ * decoder_table: the loading and drawing loops are left untouched.
+ */
+template <int type> struct fft_decoder;
+
+/* the magnitudes are summed unscaled, the scale 2^max_exp of every bin
+ * is applied once to the sum: shifting each bin overflows 32 bits for
+ * large exponents and up to 1024 ath10k bins
+ */
+static double bin_square_sum(const quint8 *data, qint32 num_bins, quint8 max_exp)
+{
+    quint64 datasquaresum = 0;
+
+    for (qint32 i = 0; i < num_bins; i++)
+        datasquaresum += (quint32) data[i] * data[i];
+
+    return ldexp((double) datasquaresum, 2 * max_exp);
+}
+
+/* append num_bins evenly spaced bins starting at freq. The power offset
+ * is the part of the bin power shared by all the bins of the sample
+ */
+static void append_bins(const quint8 *data, qint32 num_bins, quint8 max_exp,
+                        float pwr_offset, float freq, float step,
+                        QPolygonF &sample)
+{
+    qint32 size = sample.size();
+    sample.resize(size + num_bins);
+    QPointF *points = sample.data() + size;
+    float scale = ldexp(1.0, max_exp);
+
+    for (qint32 i = 0; i < num_bins; i++) {
+        float value = qMax(data[i] * scale, 1.0f);
+        points[i] = QPointF(freq + step * i, pwr_offset + 20 * log10f(value));
+    }
+}
+
+template <>
+struct fft_decoder<ATH_FFT_SAMPLE_HT20>
+{
+    typedef fft_sample_ht20 sample_type;
+    enum { num_bins = SPECTRAL_HT20_NUM_BINS };
+
+    static bool valid_len(quint32 len)
+    {
+        return len == sizeof(sample_type);
+    }
+
+    static quint16 decode(const quint8 *src, quint32 len, quint8 *dst)
+    {
+        const sample_type *sample = (const sample_type *) src;
+        sample_type *fft_data = (sample_type *) dst;
+
+        memcpy(dst, src, len);
+        fft_data->tlv.length = qFromBigEndian(sample->tlv.length);
+        fft_data->freq = qFromBigEndian(sample->freq);
+        fft_data->max_magnitude = qFromBigEndian(sample->max_magnitude);
+        fft_data->tsf = qFromBigEndian((quint64) sample->tsf);
+
+        return fft_data->freq;
+    }
+
+    static quint64 tsf(const fft_sample_tlv *tlv)
+    {
+        return ((const sample_type *) tlv)->tsf;
+    }
+
+    static quint16 max_magnitude(const fft_sample_tlv *tlv)
+    {
+        return ((const sample_type *) tlv)->max_magnitude;
+    }
+
+    static void bin_pwr(const fft_sample_tlv *tlv, QPolygonF &sample)
+    {
+        const sample_type *fft_data = (const sample_type *) tlv;
+
+        double datasquaresum = bin_square_sum(fft_data->data, num_bins,
+                                              fft_data->max_exp);
+        float pwr_offset = fft_data->noise + fft_data->rssi -
+                           log10(datasquaresum) * 10;
+
+        append_bins(fft_data->data, num_bins, fft_data->max_exp, pwr_offset,
+                    fft_data->freq - 10.0, 20.0 / num_bins, sample);
+    }
+};
+
+template <>
+struct fft_decoder<ATH_FFT_SAMPLE_HT20_40>
+{
+    typedef fft_sample_ht20_40 sample_type;
+    enum { num_bins = SPECTRAL_HT20_40_NUM_BINS, half_bins = num_bins / 2 };
+
+    static bool valid_len(quint32 len)
+    {
+        return len == sizeof(sample_type);
+    }
+
+    static quint16 decode(const quint8 *src, quint32 len, quint8 *dst)
+    {
+        const sample_type *sample = (const sample_type *) src;
+        sample_type *fft_data = (sample_type *) dst;
+
+        memcpy(dst, src, len);
+        fft_data->tlv.length = qFromBigEndian(sample->tlv.length);
+        fft_data->freq = qFromBigEndian(sample->freq);
+        fft_data->lower_max_magnitude = qFromBigEndian(sample->lower_max_magnitude);
+        fft_data->upper_max_magnitude = qFromBigEndian(sample->upper_max_magnitude);
+        fft_data->tsf = qFromBigEndian((quint64) sample->tsf);
+
+        return fft_data->freq;
+    }
+
+    static quint64 tsf(const fft_sample_tlv *tlv)
+    {
+        return ((const sample_type *) tlv)->tsf;
+    }
+
+    static quint16 max_magnitude(const fft_sample_tlv *tlv)
+    {
+        const sample_type *fft_data = (const sample_type *) tlv;
+        quint16 lower = fft_data->lower_max_magnitude;
+        quint16 upper = fft_data->upper_max_magnitude;
+
+        return qMax(lower, upper);
+    }
+
+    static void bin_pwr(const fft_sample_tlv *tlv, QPolygonF &sample)
+    {
+        const sample_type *fft_data = (const sample_type *) tlv;
+        const quint8 *lower = fft_data->data;
+        const quint8 *upper = fft_data->data + half_bins;
+
+        double lower_datasquaresum = bin_square_sum(lower, half_bins,
+                                                    fft_data->max_exp);
+        double upper_datasquaresum = bin_square_sum(upper, half_bins,
+                                                    fft_data->max_exp);
+
+        /* the control channel is the lower one for HT40+ */
+        float lower_freq = (fft_data->channel_type == NL80211_CHAN_HT40PLUS)
+                           ? fft_data->freq - 10.0 : fft_data->freq - 30.0;
+
+        append_bins(lower, half_bins, fft_data->max_exp,
+                    fft_data->lower_noise + fft_data->lower_rssi -
+                    log10(lower_datasquaresum) * 10,
+                    lower_freq, 20.0 / half_bins, sample);
+        append_bins(upper, half_bins, fft_data->max_exp,
+                    fft_data->upper_noise + fft_data->upper_rssi -
+                    log10(upper_datasquaresum) * 10,
+                    lower_freq + 20.0, 20.0 / half_bins, sample);
+    }
+};
+
+template <>
+struct fft_decoder<ATH_FFT_SAMPLE_ATH10K>
+{
+    typedef fft_sample_ath10k sample_type;
+    enum { max_bins = SPECTRAL_ATH10K_MAX_NUM_BINS };
+
+    static bool valid_len(quint32 len)
+    {
+        return len > sizeof(sample_type) && len <= sizeof(sample_type) + max_bins;
+    }
+
+    static quint16 decode(const quint8 *src, quint32 len, quint8 *dst)
+    {
+        const sample_type *sample = (const sample_type *) src;
+        sample_type *fft_data = (sample_type *) dst;
+
+        memcpy(dst, src, len);
+        fft_data->tlv.length = qFromBigEndian(sample->tlv.length);
+        fft_data->freq1 = qFromBigEndian(sample->freq1);
+        fft_data->freq2 = qFromBigEndian(sample->freq2);
+        fft_data->noise = qFromBigEndian(sample->noise);
+        fft_data->max_magnitude = qFromBigEndian(sample->max_magnitude);
+        fft_data->total_gain_db = qFromBigEndian(sample->total_gain_db);
+        fft_data->base_pwr_db = qFromBigEndian(sample->base_pwr_db);
+        fft_data->tsf = qFromBigEndian((quint64) sample->tsf);
+
+        return fft_data->freq1;
+    }
+
+    static quint64 tsf(const fft_sample_tlv *tlv)
+    {
+        return ((const sample_type *) tlv)->tsf;
+    }
+
+    static quint16 max_magnitude(const fft_sample_tlv *tlv)
+    {
+        return ((const sample_type *) tlv)->max_magnitude;
+    }
+
+    static void bin_pwr(const fft_sample_tlv *tlv, QPolygonF &sample)
+    {
+        const sample_type *fft_data = (const sample_type *) tlv;
+        qint32 bins = sizeof(fft_sample_tlv) + tlv->length - sizeof(sample_type);
+
+        double datasquaresum = bin_square_sum(fft_data->data, bins,
+                                              fft_data->max_exp);
+        float pwr_offset = fft_data->noise + fft_data->rssi -
+                           log10(datasquaresum) * 10;
+        float step = (float) fft_data->chan_width_mhz / bins;
+
+        append_bins(fft_data->data, bins, fft_data->max_exp, pwr_offset,
+                    fft_data->freq1 - fft_data->chan_width_mhz / 2.0,
+                    step, sample);
+    }
+};
+
+#define TLV_DECODER(type) {             \
+    fft_decoder<type>::valid_len,       \
+    fft_decoder<type>::decode,          \
+    fft_decoder<type>::bin_pwr,         \
+    fft_decoder<type>::tsf,             \
+    fft_decoder<type>::max_magnitude    \
+}
+
+/* jump table indexed by the TLV type */
+static const struct tlv_decoder decoder_table[] = {
+    { NULL, NULL, NULL, NULL, NULL },
+    TLV_DECODER(ATH_FFT_SAMPLE_HT20),
+    TLV_DECODER(ATH_FFT_SAMPLE_HT20_40),
+    TLV_DECODER(ATH_FFT_SAMPLE_ATH10K),
+};
+
+#define NUM_TLV_DECODERS    (sizeof(decoder_table) / sizeof(decoder_table[0]))
+
+/* return the decoder registered for type or NULL */
+const struct tlv_decoder *tlv_decoder_lookup(quint8 type)
+{
+    if (type >= NUM_TLV_DECODERS || !decoder_table[type].decode)
+        return NULL;
+
+    return &decoder_table[type];
+}
+
+/* return the length of the TLV at ptr or -1 if it is not a valid sample */
+qint32 tlv_sample_len(const quint8 *ptr, qint64 avail)
+{
+    if (avail < (qint64) sizeof(fft_sample_tlv))
+        return -1;
+
+    const fft_sample_tlv *tlv = (const fft_sample_tlv *) ptr;
+    const tlv_decoder *decoder = tlv_decoder_lookup(tlv->type);
+    if (!decoder)
+        return -1;
+
+    quint32 len = sizeof(fft_sample_tlv) + qFromBigEndian(tlv->length);
+    if (!decoder->valid_len(len) || len > avail)
+        return -1;
+
+    return len;
+}
@@ -0,0 +1,34 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <QPolygonF>
+
+#include "athscan.h"
+
+/* ath10k samples carry a variable number of bins */
+#define SPECTRAL_ATH10K_MAX_NUM_BINS    1024
+/* size of a buffer large enough for any decoded sample */
+#define SCAN_MAX_SAMPLE_LEN     (sizeof(fft_sample_ath10k) + SPECTRAL_ATH10K_MAX_NUM_BINS)
+
+/* entry of the decoder registry, one for each supported TLV type.
+ * The lengths include the TLV header.
+ */
+struct tlv_decoder {
+    /* check the length of a record */
+    bool (*valid_len)(quint32 len);
+    /* copy a record in dst converting multi-byte fields to host order,
+     * return the center frequency of the sample
+     */
+    quint16 (*decode)(const quint8 *src, quint32 len, quint8 *dst);
+    /* append the power of every bin of a decoded record */
+    void (*bin_pwr)(const fft_sample_tlv *, QPolygonF &);
+    /* timestamp [us] of a decoded record */
+    quint64 (*tsf)(const fft_sample_tlv *);
+    /* largest FFT magnitude of a decoded record */
+    quint16 (*max_magnitude)(const fft_sample_tlv *);
+};
+
+const struct tlv_decoder *tlv_decoder_lookup(quint8 type);
+qint32 tlv_sample_len(const quint8 *ptr, qint64 avail);
+
+#endif // DECODER_H
@@ -0,0 +1,106 @@
+#include "hud.h"
+#include "perf.h"
+
+#include <QPainter>
+
+PerfCanvas::PerfCanvas(QwtPlot *plot) :
+    QwtPlotCanvas(plot)
+{
+}
+
+void PerfCanvas::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    QwtPlotCanvas::paintEvent(event);
+
+    perf_counters *stats = perf_stats();
+    stats->paint_us.fetchAndAddRelaxed(timer.nsecsElapsed() / 1000);
+    stats->frames.fetchAndAddRelaxed(1);
+}
+
+PerfHud::PerfHud(QWidget *canvas) :
+    QwtWidgetOverlay(canvas),
+    _dropped(0),
+    _lost_frames(0)
+{
+    QFont hud_font("Monospace", 9);
+    hud_font.setStyleHint(QFont::TypeWriter);
+    setFont(hud_font);
+    setMaskMode(QwtWidgetOverlay::MaskHint);
+
+    connect(&_timer, SIGNAL(timeout()), this, SLOT(sample()));
+    _timer.start(HUD_UPDATE_MS);
+    _clock.start();
+
+    sample();
+}
+
+/* take and reset the counters of the last interval */
+void PerfHud::sample()
+{
+    perf_counters *stats = perf_stats();
+    double elapsed = qMax(_clock.restart(), (qint64) 1) / 1000.0;
+
+    qint32 samples = stats->samples.fetchAndStoreRelaxed(0);
+    qint32 decode_us = stats->decode_us.fetchAndStoreRelaxed(0);
+    qint32 bin_pwr_us = stats->bin_pwr_us.fetchAndStoreRelaxed(0);
+    qint32 paint_us = stats->paint_us.fetchAndStoreRelaxed(0);
+    qint32 frames = stats->frames.fetchAndStoreRelaxed(0);
+    _dropped += stats->dropped.fetchAndStoreRelaxed(0);
+    _lost_frames += stats->lost_frames.fetchAndStoreRelaxed(0);
+
+    if (!isVisible())
+        return;
+
+    double per_sample = samples ? 1000.0 / samples : 0.0;
+
+    _lines.clear();
+    _lines += QString("ingest   %1 samples/s").arg(samples / elapsed, 0, 'f', 0);
+    _lines += QString("decode   %1 ns/sample").arg(decode_us * per_sample, 0, 'f', 0);
+    _lines += QString("bin pwr  %1 ns/sample").arg(bin_pwr_us * per_sample, 0, 'f', 0);
+    _lines += QString("paint    %1 ms/frame, %2 fps")
+              .arg(frames ? paint_us / 1000.0 / frames : 0.0, 0, 'f', 1)
+              .arg(frames / elapsed, 0, 'f', 0);
+    _lines += QString("queue    %1 batches").arg(stats->queued.load());
+    _lines += QString("dropped  %1 samples, %2 frames lost")
+              .arg(_dropped).arg(_lost_frames);
+    _lines += QString("store    %1 MB in RAM, %2 MB spilled")
+              .arg(stats->store_kb.load() / 1024.0, 0, 'f', 1)
+              .arg(stats->spilled_kb.load() / 1024.0, 0, 'f', 1);
+
+    updateOverlay();
+}
+
+QRect PerfHud::text_rect() const
+{
+    const QFontMetrics fm(font());
+
+    qint32 width = 0;
+    for (qint32 i = 0; i < _lines.size(); i++)
+        width = qMax(width, fm.width(_lines[i]));
+
+    return QRect(10, 10, width + 16, _lines.size() * fm.lineSpacing() + 12);
+}
+
+QRegion PerfHud::maskHint() const
+{
+    return text_rect();
+}
+
+void PerfHud::drawOverlay(QPainter *painter) const
+{
+    const QRect rect = text_rect();
+    const QFontMetrics fm(font());
+
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(QColor(0, 0, 0, 160));
+    painter->drawRect(rect);
+
+    painter->setPen(Qt::yellow);
+    for (qint32 i = 0; i < _lines.size(); i++)
+        painter->drawText(rect.left() + 8,
+                          rect.top() + 6 + fm.ascent() + i * fm.lineSpacing(),
+                          _lines[i]);
+}
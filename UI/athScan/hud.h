@@ -0,0 +1,53 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <qwt_widget_overlay.h>
+#include <qwt_plot_canvas.h>
+
+/* interval between two updates of the HUD */
+#define HUD_UPDATE_MS   500
+
+/* PerfCanvas accounts the time spent painting the plot */
+class PerfCanvas : public QwtPlotCanvas
+{
+public:
+    explicit PerfCanvas(QwtPlot *plot = NULL);
+
+protected:
+    virtual void paintEvent(QPaintEvent *);
+};
+
+/* PerfHud shows the performance counters on top of the canvas.
+ *
+ * Being a QwtWidgetOverlay, updating it repaints the overlay only and
+ * never triggers a replot of the canvas. The counters are sampled every
+ * HUD_UPDATE_MS, even when the HUD is hidden, so that they always cover
+ * the last interval.
+ */
+class PerfHud : public QwtWidgetOverlay
+{
+    Q_OBJECT
+
+public:
+    explicit PerfHud(QWidget *canvas);
+
+protected:
+    virtual void drawOverlay(QPainter *) const;
+    virtual QRegion maskHint() const;
+
+private slots:
+    void sample();
+
+private:
+    QRect text_rect() const;
+
+    QTimer _timer;
+    QElapsedTimer _clock;
+    QStringList _lines;
+    qint64 _dropped, _lost_frames;
+};
+
+#endif // HUD_H
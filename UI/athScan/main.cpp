@@ -1,11 +1,148 @@
 #include "athscan.h"
+#include "recorder.h"
 #include <QApplication>
+#include <QStringList>
+#include <QMessageBox>
+
+#include <qwt_trace.h>
+
+/* --record FILE enables the triggered recording of the loaded samples,
+ * with --trigger-pwr DBM and/or --trigger-magnitude N as triggers and
+ * --pre-trigger MS, --post-trigger MS as windows
+ */
+static TriggerRecorder *create_recorder(const QStringList &args)
+{
+    qint32 idx = args.indexOf("--record");
+    if (idx < 0 || idx + 1 >= args.size())
+        return NULL;
+
+    TriggerRecorder *recorder = new TriggerRecorder(args[idx + 1]);
+
+    for (qint32 i = 0; i + 1 < args.size(); i++) {
+        const QString &value = args[i + 1];
+
+        if (args[i] == "--trigger-pwr")
+            recorder->add_trigger(new PowerTrigger(value.toFloat()));
+        else if (args[i] == "--trigger-magnitude")
+            recorder->add_trigger(new MagnitudeTrigger(value.toUShort()));
+        else if (args[i] == "--pre-trigger")
+            recorder->set_pre_trigger(value.toUInt());
+        else if (args[i] == "--post-trigger")
+            recorder->set_post_trigger(value.toUInt());
+    }
+
+    return recorder;
+}
+
+/* --replay FILE replays a capture at the pace of its TSF, scaled by
+ * --speed FACTOR, or as fast as possible with --firehose
+ */
+static void start_replay(AthScan *w, const QStringList &args)
+{
+    qint32 idx = args.indexOf("--replay");
+    if (idx < 0 || idx + 1 >= args.size())
+        return;
+
+    double speed = 1.0;
+    qint32 speed_idx = args.indexOf("--speed");
+    if (speed_idx >= 0 && speed_idx + 1 < args.size())
+        speed = args[speed_idx + 1].toDouble();
+
+    w->start_replay(args[idx + 1], speed, args.contains("--firehose"));
+}
+
+/* --connect ADDRESS receives the samples streamed by athAgent, see
+ * ScanNetSource for the address format
+ */
+static void start_network(AthScan *w, const QStringList &args)
+{
+    qint32 idx = args.indexOf("--connect");
+    if (idx < 0 || idx + 1 >= args.size())
+        return;
+
+    w->start_network(args[idx + 1]);
+}
+
+/* --memory-budget MB bounds the RAM used by the decoded samples, cold
+ * samples are compressed and then spilled to $TMPDIR
+ */
+static void set_memory_budget(AthScan *w, const QStringList &args)
+{
+    qint32 idx = args.indexOf("--memory-budget");
+    if (idx < 0 || idx + 1 >= args.size())
+        return;
+
+    w->set_memory_budget(args[idx + 1].toLongLong() * 1024 * 1024);
+}
+
+/* --mask FILE checks the samples against a spectral mask, see
+ * SpectralMask for the format. The violations of every cell are written
+ * as CSV at exit with --mask-report FILE
+ */
+static int set_mask(AthScan *w, const QStringList &args)
+{
+    qint32 idx = args.indexOf("--mask");
+    if (idx < 0 || idx + 1 >= args.size())
+        return 0;
+
+    return w->set_mask(args[idx + 1]);
+}
+
+static void set_mask_report(AthScan *w, const QStringList &args)
+{
+    qint32 idx = args.indexOf("--mask-report");
+    if (idx < 0 || idx + 1 >= args.size())
+        return;
+
+    w->set_mask_report(args[idx + 1]);
+}
+
+/* --compare A B compares two captures cell by cell, see ScanCompare */
+static void start_compare(AthScan *w, const QStringList &args)
+{
+    qint32 idx = args.indexOf("--compare");
+    if (idx < 0 || idx + 2 >= args.size())
+        return;
+
+    w->start_compare(args[idx + 1], args[idx + 2]);
+}
+
+/* --trace FILE records the trace points from the start and saves them
+ * as Chrome trace event JSON at exit
+ */
+static QString trace_file(const QStringList &args)
+{
+    qint32 idx = args.indexOf("--trace");
+    if (idx < 0 || idx + 1 >= args.size())
+        return QString();
+
+    return args[idx + 1];
+}
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    QString trace = trace_file(a.arguments());
+    if (!trace.isEmpty())
+        QwtTrace::setEnabled(true);
+
     AthScan w;
+    w.set_recorder(create_recorder(a.arguments()));
+    set_memory_budget(&w, a.arguments());
+    if (set_mask(&w, a.arguments()) < 0)
+        QMessageBox::information(0, "error", "error loading the spectral mask");
+    set_mask_report(&w, a.arguments());
     w.show();
+    start_replay(&w, a.arguments());
+    start_network(&w, a.arguments());
+    start_compare(&w, a.arguments());
+
+    int ret = a.exec();
+
+    if (!trace.isEmpty()) {
+        QwtTrace::setEnabled(false);
+        QwtTrace::writeChromeTrace(trace);
+    }
 
-    return a.exec();
+    return ret;
 }
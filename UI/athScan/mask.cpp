@@ -0,0 +1,363 @@
+#include "mask.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QRegExp>
+#include <qmath.h>
+#include <float.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+SpectralMask::SpectralMask()
+{
+}
+
+/* the points are kept sorted by frequency */
+void SpectralMask::add_point(float freq, float limit)
+{
+    qint32 i = _points.size();
+    while (i > 0 && _points[i - 1].x() > freq)
+        i--;
+
+    _points.insert(i, QPointF(freq, limit));
+}
+
+void SpectralMask::clear()
+{
+    _points.clear();
+}
+
+int SpectralMask::load(QString file_name)
+{
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return -1;
+
+    SpectralMask mask;
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        QStringList fields = line.split(QRegExp("[\\s,;]+"));
+        bool freq_ok = false, limit_ok = false;
+        float freq = fields.value(0).toFloat(&freq_ok);
+        float limit = fields.value(1).toFloat(&limit_ok);
+        if (fields.size() != 2 || !freq_ok || !limit_ok)
+            return -1;
+
+        mask.add_point(freq, limit);
+    }
+
+    if (mask._points.size() < 2)
+        return -1;
+
+    *this = mask;
+
+    return 0;
+}
+
+bool SpectralMask::is_empty() const
+{
+    return _points.size() < 2;
+}
+
+float SpectralMask::min_freq() const
+{
+    return _points.isEmpty() ? 0.0 : _points.first().x();
+}
+
+float SpectralMask::max_freq() const
+{
+    return _points.isEmpty() ? 0.0 : _points.last().x();
+}
+
+/* FLT_MAX out of the mask span */
+float SpectralMask::limit(float freq) const
+{
+    if (is_empty() || freq < min_freq() || freq > max_freq())
+        return FLT_MAX;
+
+    qint32 i = 1;
+    while (i < _points.size() - 1 && _points[i].x() < freq)
+        i++;
+
+    const QPointF &p0 = _points[i - 1];
+    const QPointF &p1 = _points[i];
+    if (p1.x() <= p0.x())
+        return qMin(p0.y(), p1.y());
+
+    return p0.y() + (p1.y() - p0.y()) * (freq - p0.x()) / (p1.x() - p0.x());
+}
+
+QPolygonF SpectralMask::points() const
+{
+    return _points;
+}
+
+MaskViolations::MaskViolations() :
+    _base_freq(0.0),
+    _num_cells(0),
+    _first(0),
+    _last(-1),
+    _records(0),
+    _violating(0)
+{
+}
+
+void MaskViolations::set_mask(const SpectralMask &mask)
+{
+    _limits.clear();
+    _num_cells = 0;
+
+    if (!mask.is_empty()) {
+        _base_freq = mask.min_freq();
+        _num_cells = qMax((qint32) ceilf((mask.max_freq() - mask.min_freq()) / MASK_CELL_WIDTH), 1);
+
+        /* the limit is piecewise linear, its lowest value over a cell is
+         * at one of the edges or at a point of the mask inside the cell
+         */
+        QPolygonF points = mask.points();
+        _limits.fill(FLT_MAX, _num_cells + 2);
+        for (qint32 i = 0; i < _num_cells; i++) {
+            float start = _base_freq + i * MASK_CELL_WIDTH;
+            float end = qMin(start + (float) MASK_CELL_WIDTH, mask.max_freq());
+
+            float limit = qMin(mask.limit(start), mask.limit(end));
+            for (qint32 k = 0; k < points.size(); k++) {
+                if (points[k].x() > start && points[k].x() < end)
+                    limit = qMin(limit, (float) points[k].y());
+            }
+            _limits[i + 1] = limit;
+        }
+    }
+
+    _violations.fill(0, _num_cells + 2);
+    _worst.fill(0.0, _num_cells + 2);
+    _worst_tsf.fill(0, _num_cells + 2);
+    _last_tsf.fill(0, _num_cells + 2);
+
+    _first = _num_cells;
+    _last = -1;
+    _records = _violating = 0;
+}
+
+bool MaskViolations::is_active() const
+{
+    return _num_cells > 0;
+}
+
+/* must be called for the internal cell index, see _limits */
+inline void MaskViolations::violation(qint32 cell, float margin, quint64 tsf)
+{
+    _violations[cell]++;
+    if (margin > _worst[cell]) {
+        _worst[cell] = margin;
+        _worst_tsf[cell] = tsf;
+    }
+    _last_tsf[cell] = tsf;
+
+    _first = qMin(_first, cell - 1);
+    _last = qMax(_last, cell - 1);
+}
+
+/* check the bins of a sample, evenly spaced and given by their lower
+ * edge, as computed by the tlv decoders
+ */
+void MaskViolations::check(const QPointF *bins, qint32 num_bins, quint64 tsf)
+{
+    if (!is_active() || num_bins <= 0)
+        return;
+
+    const float *limits = _limits.constData();
+    const qint32 max_cell = _num_cells + 1;
+    const double width = (num_bins > 1) ? bins[1].x() - bins[0].x() : 0.0;
+
+    /* internal cell of a bin, shifted by the sentinel */
+    const double offset = width / 2 - _base_freq + MASK_CELL_WIDTH;
+    const double scale = 1.0 / MASK_CELL_WIDTH;
+
+    bool violated = false;
+    qint32 i = 0;
+
+#if defined(__SSE2__)
+    /* QPointF is a pair of doubles with SSE2 */
+    const __m128d offset2 = _mm_set1_pd(offset);
+    const __m128d scale2 = _mm_set1_pd(scale);
+    const __m128d zero = _mm_setzero_pd();
+
+    for (; i + 1 < num_bins; i += 2) {
+        const __m128d p0 = _mm_loadu_pd((const double *) (bins + i));
+        const __m128d p1 = _mm_loadu_pd((const double *) (bins + i + 1));
+
+        const __m128d x = _mm_unpacklo_pd(p0, p1);
+        const __m128d y = _mm_unpackhi_pd(p0, p1);
+
+        /* truncation is a floor for the bins of the span, the ones
+         * below it land on the sentinel or are negative
+         */
+        const __m128i cells = _mm_cvttpd_epi32(_mm_mul_pd(_mm_add_pd(x, offset2), scale2));
+        qint32 c0 = qBound(0, _mm_cvtsi128_si32(cells), max_cell);
+        qint32 c1 = qBound(0, _mm_cvtsi128_si32(_mm_shuffle_epi32(cells, 1)), max_cell);
+
+        const __m128d margin = _mm_sub_pd(y, _mm_set_pd(limits[c1], limits[c0]));
+        qint32 over = _mm_movemask_pd(_mm_cmpgt_pd(margin, zero));
+        if (!over)
+            continue;
+
+        double m[2];
+        _mm_storeu_pd(m, margin);
+        if (over & 1)
+            violation(c0, m[0], tsf);
+        if (over & 2)
+            violation(c1, m[1], tsf);
+        violated = true;
+    }
+#endif
+
+    for (; i < num_bins; i++) {
+        double pos = (bins[i].x() + offset) * scale;
+        qint32 cell = (pos <= 0.0) ? 0 : qMin((qint32) pos, max_cell);
+
+        float margin = bins[i].y() - limits[cell];
+        if (margin > 0.0) {
+            violation(cell, margin, tsf);
+            violated = true;
+        }
+    }
+
+    _records++;
+    if (violated)
+        _violating++;
+}
+
+/* add the violations of a batch, checked against the same mask */
+void MaskViolations::merge(const MaskViolations &other)
+{
+    if (other._num_cells != _num_cells)
+        return;
+
+    for (qint32 i = other._first + 1; i <= other._last + 1; i++) {
+        if (!other._violations[i])
+            continue;
+
+        _violations[i] += other._violations[i];
+        if (other._worst[i] > _worst[i]) {
+            _worst[i] = other._worst[i];
+            _worst_tsf[i] = other._worst_tsf[i];
+        }
+        _last_tsf[i] = other._last_tsf[i];
+    }
+
+    if (other._first <= other._last) {
+        _first = qMin(_first, other._first);
+        _last = qMax(_last, other._last);
+    }
+
+    _records += other._records;
+    _violating += other._violating;
+}
+
+void MaskViolations::clear()
+{
+    /* only the violated range has to be reset */
+    for (qint32 i = _first + 1; i <= _last + 1; i++) {
+        _violations[i] = 0;
+        _worst[i] = 0.0;
+        _worst_tsf[i] = _last_tsf[i] = 0;
+    }
+
+    _first = _num_cells;
+    _last = -1;
+    _records = _violating = 0;
+}
+
+/* true when no bin violated the mask */
+bool MaskViolations::is_empty() const
+{
+    return _last < _first;
+}
+
+qint32 MaskViolations::first_cell() const
+{
+    return _first;
+}
+
+qint32 MaskViolations::last_cell() const
+{
+    return _last;
+}
+
+qint32 MaskViolations::num_cells() const
+{
+    return _num_cells;
+}
+
+/* lower edge of a cell [MHz] */
+float MaskViolations::cell_freq(qint32 cell) const
+{
+    return _base_freq + cell * MASK_CELL_WIDTH;
+}
+
+float MaskViolations::cell_limit(qint32 cell) const
+{
+    return _limits[cell + 1];
+}
+
+quint32 MaskViolations::violations(qint32 cell) const
+{
+    return _violations[cell + 1];
+}
+
+float MaskViolations::worst_margin(qint32 cell) const
+{
+    return _worst[cell + 1];
+}
+
+quint64 MaskViolations::worst_tsf(qint32 cell) const
+{
+    return _worst_tsf[cell + 1];
+}
+
+quint64 MaskViolations::last_tsf(qint32 cell) const
+{
+    return _last_tsf[cell + 1];
+}
+
+quint64 MaskViolations::records() const
+{
+    return _records;
+}
+
+quint64 MaskViolations::violating_records() const
+{
+    return _violating;
+}
+
+/* write the accounting of every cell of the mask as CSV */
+int MaskViolations::write_report(QString file_name) const
+{
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return -1;
+
+    QTextStream stream(&file);
+    stream << "# " << _violating << " of " << _records << " samples over the mask\n";
+    stream << "freq_mhz,limit_dbm,violations,worst_margin_db,worst_tsf,last_tsf\n";
+
+    for (qint32 i = 0; i < _num_cells; i++) {
+        stream << cell_freq(i) << ',' << cell_limit(i) << ','
+               << violations(i) << ',' << worst_margin(i) << ','
+               << worst_tsf(i) << ',' << last_tsf(i) << '\n';
+    }
+
+    stream.flush();
+
+    return (stream.status() == QTextStream::Ok) ? 0 : -1;
+}
@@ -0,0 +1,108 @@
+#ifndef MASK_H
+#define MASK_H
+
+#include <QVector>
+#include <QPolygonF>
+#include <QMetaType>
+#include <QString>
+
+#include "panorama.h"
+
+/* violations are accounted on the cells of the panorama grid */
+#define MASK_CELL_WIDTH     PANORAMA_CELL_WIDTH
+/* largest number of violation zones drawn on the plot */
+#define MASK_MAX_ZONES      64
+
+/* SpectralMask is a piecewise-linear power limit [dbm] over frequency
+ * [MHz]. There is no limit outside of the first and last points.
+ *
+ * Masks are loaded from text files holding a "freq limit" pair per line,
+ * lines starting with # are comments, e.g. for a 20MHz channel at 2437:
+ *   2417 -70
+ *   2426 -50
+ *   2427 -30
+ *   2447 -30
+ *   2448 -50
+ *   2457 -70
+ */
+class SpectralMask
+{
+public:
+    SpectralMask();
+
+    int load(QString file_name);
+    void add_point(float freq, float limit);
+    void clear();
+
+    bool is_empty() const;
+    float min_freq() const;
+    float max_freq() const;
+    float limit(float freq) const;
+    QPolygonF points() const;
+
+private:
+    QPolygonF _points;
+};
+
+/* MaskViolations checks the decoded samples against a mask.
+ *
+ * The limit of every cell of the mask span is computed once, as the
+ * lowest limit over the cell, so that checking a sample is a gather and
+ * a compare per bin, done two bins at a time with SSE2 when available.
+ * Bins are assigned to the cell of their center. For every cell the
+ * number of violating bins, the worst margin [db] over the limit and the
+ * TSF of the worst and of the last violation are accounted.
+ *
+ * Like SpectrumPanorama, the ingestion threads check their batches in a
+ * local object, merged into the one of the GUI thread. The limits are
+ * implicitly shared by the copies.
+ */
+class MaskViolations
+{
+public:
+    MaskViolations();
+
+    void set_mask(const SpectralMask &);
+    bool is_active() const;
+
+    void check(const QPointF *bins, qint32 num_bins, quint64 tsf);
+    void merge(const MaskViolations &);
+    void clear();
+
+    bool is_empty() const;
+    qint32 first_cell() const;
+    qint32 last_cell() const;
+    qint32 num_cells() const;
+
+    float cell_freq(qint32) const;
+    float cell_limit(qint32) const;
+    quint32 violations(qint32) const;
+    float worst_margin(qint32) const;
+    quint64 worst_tsf(qint32) const;
+    quint64 last_tsf(qint32) const;
+
+    quint64 records() const;
+    quint64 violating_records() const;
+
+    int write_report(QString file_name) const;
+
+private:
+    void violation(qint32 cell, float margin, quint64 tsf);
+
+    /* cells 0 and _num_cells + 1 are sentinels without limit, for the
+     * bins out of the mask span
+     */
+    QVector<float> _limits;
+    QVector<quint32> _violations;
+    QVector<float> _worst;
+    QVector<quint64> _worst_tsf, _last_tsf;
+
+    double _base_freq;
+    qint32 _num_cells;
+    qint32 _first, _last;
+    quint64 _records, _violating;
+};
+
+Q_DECLARE_METATYPE(MaskViolations)
+
+#endif // MASK_H
@@ -0,0 +1,185 @@
+#include "panorama.h"
+#include "athscan.h"
+
+#include <qmath.h>
+
+SpectrumPanorama::SpectrumPanorama() :
+    _first(PANORAMA_NUM_CELLS),
+    _last(-1)
+{
+}
+
+bool SpectrumPanorama::is_empty() const
+{
+    return _last < _first;
+}
+
+qint32 SpectrumPanorama::first_cell() const
+{
+    return _first;
+}
+
+qint32 SpectrumPanorama::last_cell() const
+{
+    return _last;
+}
+
+float SpectrumPanorama::cell_freq(qint32 cell) const
+{
+    return PANORAMA_MIN_FREQ + (cell + 0.5) * PANORAMA_CELL_WIDTH;
+}
+
+float SpectrumPanorama::cell_pwr(qint32 cell) const
+{
+    const panorama_cell &c = _cells[cell];
+    if (c.weight <= 0.0)
+        return PANORAMA_FLOOR_PWR;
+
+    return 10 * log10(c.pwr_sum / c.weight);
+}
+
+float SpectrumPanorama::cell_max_pwr(qint32 cell) const
+{
+    return _cells[cell].max_pwr;
+}
+
+void SpectrumPanorama::clear()
+{
+    /* only the covered range has to be reset */
+    for (qint32 i = _first; i <= _last; i++) {
+        panorama_cell &c = _cells[i];
+        c.pwr_sum = c.weight = 0.0;
+        c.max_pwr = PANORAMA_FLOOR_PWR;
+    }
+
+    _first = PANORAMA_NUM_CELLS;
+    _last = -1;
+}
+
+/* spread a bin covering [freq, freq + width[ on the cells it overlaps */
+void SpectrumPanorama::add_bin(float freq, float width, float pwr, float weight)
+{
+    float start = (freq - PANORAMA_MIN_FREQ) / PANORAMA_CELL_WIDTH;
+    float end = start + width / PANORAMA_CELL_WIDTH;
+
+    qint32 first = qMax((qint32) floorf(start), 0);
+    qint32 last = qMin((qint32) ceilf(end) - 1, PANORAMA_NUM_CELLS - 1);
+    if (first > last)
+        return;
+
+    float lin_pwr = powf(10.0, pwr / 10);
+
+    for (qint32 i = first; i <= last; i++) {
+        float overlap = qMin(end, (float) (i + 1)) - qMax(start, (float) i);
+        if (overlap <= 0.0)
+            continue;
+
+        panorama_cell &c = _cells[i];
+        c.pwr_sum += (double) weight * overlap * lin_pwr;
+        c.weight += (double) weight * overlap;
+        if (pwr > c.max_pwr)
+            c.max_pwr = pwr;
+    }
+
+    if (first < _first)
+        _first = first;
+    if (last > _last)
+        _last = last;
+}
+
+void SpectrumPanorama::add_sample(fft_sample_tlv *tlv)
+{
+    if (_cells.isEmpty()) {
+        panorama_cell empty = { 0.0, 0.0, PANORAMA_FLOOR_PWR };
+        _cells.fill(empty, PANORAMA_NUM_CELLS);
+    }
+
+    _bins.clear();
+    AthScan::compute_bin_pwr(tlv, _bins);
+    if (_bins.isEmpty())
+        return;
+
+    /* bins are evenly spaced, whatever the sample format */
+    float min_freq = _bins[0].x(), max_freq = _bins[0].x();
+    for (qint32 i = 1; i < _bins.size(); i++) {
+        if (_bins[i].x() < min_freq)
+            min_freq = _bins[i].x();
+        if (_bins[i].x() > max_freq)
+            max_freq = _bins[i].x();
+    }
+    float width = (_bins.size() > 1)
+                  ? (max_freq - min_freq) / (_bins.size() - 1) : PANORAMA_CELL_WIDTH;
+    max_freq += width;
+
+    float center = (min_freq + max_freq) / 2;
+    float half_span = (max_freq - min_freq) / 2;
+
+    for (qint32 i = 0; i < _bins.size(); i++) {
+        float freq = _bins[i].x();
+        float dist = qAbs(freq + width / 2 - center) / half_span;
+        float weight = PANORAMA_EDGE_WEIGHT +
+                       (1.0 - PANORAMA_EDGE_WEIGHT) * 0.5 * (1.0 + cosf(M_PI * dist));
+
+        add_bin(freq, width, _bins[i].y(), weight);
+    }
+}
+
+void SpectrumPanorama::merge(const SpectrumPanorama &other)
+{
+    if (other.is_empty())
+        return;
+
+    if (_cells.isEmpty()) {
+        panorama_cell empty = { 0.0, 0.0, PANORAMA_FLOOR_PWR };
+        _cells.fill(empty, PANORAMA_NUM_CELLS);
+    }
+
+    for (qint32 i = other._first; i <= other._last; i++) {
+        const panorama_cell &src = other._cells[i];
+        panorama_cell &dst = _cells[i];
+
+        dst.pwr_sum += src.pwr_sum;
+        dst.weight += src.weight;
+        if (src.max_pwr > dst.max_pwr)
+            dst.max_pwr = src.max_pwr;
+    }
+
+    if (other._first < _first)
+        _first = other._first;
+    if (other._last > _last)
+        _last = other._last;
+}
+
+PanoramaData::PanoramaData(const SpectrumPanorama *panorama) :
+    _panorama(panorama)
+{
+}
+
+size_t PanoramaData::size() const
+{
+    if (_panorama->is_empty())
+        return 0;
+
+    return _panorama->last_cell() - _panorama->first_cell() + 1;
+}
+
+QPointF PanoramaData::sample(size_t i) const
+{
+    qint32 cell = _panorama->first_cell() + (qint32) i;
+
+    return QPointF(_panorama->cell_freq(cell), _panorama->cell_pwr(cell));
+}
+
+QRectF PanoramaData::boundingRect() const
+{
+    if (d_boundingRect.width() < 0.0)
+        d_boundingRect = qwtBoundingRect(*this);
+
+    return d_boundingRect;
+}
+
+/* to be called after the panorama has been modified */
+void PanoramaData::invalidate()
+{
+    d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0);
+}
@@ -0,0 +1,86 @@
+#ifndef PANORAMA_H
+#define PANORAMA_H
+
+#include <QVector>
+#include <QPolygonF>
+#include <QMetaType>
+#include <qwt_series_data.h>
+
+struct fft_sample_tlv;
+
+/* global frequency grid of the panorama [MHz] */
+#define PANORAMA_MIN_FREQ       2300
+#define PANORAMA_MAX_FREQ       6100
+#define PANORAMA_CELL_WIDTH     0.3125
+#define PANORAMA_NUM_CELLS      ((qint32) ((PANORAMA_MAX_FREQ - PANORAMA_MIN_FREQ) / PANORAMA_CELL_WIDTH))
+/* power reported for the cells not covered by any channel */
+#define PANORAMA_FLOOR_PWR      -128.0
+/* weight of the channel edges relative to the channel center */
+#define PANORAMA_EDGE_WEIGHT    0.05
+
+/* the sums are double: the weight of a cell of a long sweep soon exceeds
+ * the precision of a float, further samples would no longer change the
+ * average
+ */
+struct panorama_cell {
+    double pwr_sum;     /* weighted sum of the linear bin power */
+    double weight;      /* sum of the weights */
+    float max_pwr;      /* peak power [dbm] */
+};
+
+/* SpectrumPanorama stitches the samples of a wideband sweep on a fixed
+ * frequency grid.
+ *
+ * Every FFT bin is spread on the grid cells it overlaps, weighted by the
+ * overlap and by a raised cosine window centered on the channel, so that
+ * the edges of overlapping HT20 and HT40 channels are blended instead of
+ * being drawn on top of each other. The aggregates of all the cells are
+ * kept in a single flat array: adding a sample is O(bins), whatever the
+ * width of the sweep.
+ */
+class SpectrumPanorama
+{
+public:
+    SpectrumPanorama();
+
+    void add_sample(struct fft_sample_tlv *);
+    void merge(const SpectrumPanorama &);
+    void clear();
+
+    bool is_empty() const;
+    qint32 first_cell() const;
+    qint32 last_cell() const;
+
+    float cell_freq(qint32) const;
+    float cell_pwr(qint32) const;
+    float cell_max_pwr(qint32) const;
+
+private:
+    void add_bin(float freq, float width, float pwr, float weight);
+
+    QVector<panorama_cell> _cells;
+    qint32 _first, _last;
+    QPolygonF _bins;
+};
+
+Q_DECLARE_METATYPE(SpectrumPanorama)
+
+/* PanoramaData exposes the covered range of a panorama as the samples
+ * of a single curve, without copying the cells.
+ */
+class PanoramaData : public QwtSeriesData<QPointF>
+{
+public:
+    explicit PanoramaData(const SpectrumPanorama *);
+
+    virtual size_t size() const;
+    virtual QPointF sample(size_t) const;
+    virtual QRectF boundingRect() const;
+
+    void invalidate();
+
+private:
+    const SpectrumPanorama *_panorama;
+};
+
+#endif // PANORAMA_H
@@ -0,0 +1,34 @@
+#include "perf.h"
+
+struct perf_counters *perf_stats()
+{
+    static perf_counters counters;
+
+    return &counters;
+}
+
+PerfProbe::PerfProbe() :
+    _t0(0),
+    _t1(0),
+    _samples(0),
+    _decode_ns(0),
+    _bin_pwr_ns(0)
+{
+    _clock.start();
+}
+
+void PerfProbe::publish()
+{
+    if (!_samples)
+        return;
+
+    perf_counters *stats = perf_stats();
+    stats->samples.fetchAndAddRelaxed(_samples);
+    stats->decode_us.fetchAndAddRelaxed(_decode_ns / 1000);
+    stats->bin_pwr_us.fetchAndAddRelaxed(_bin_pwr_ns / 1000);
+
+    /* keep the remainders for the next batch */
+    _decode_ns %= 1000;
+    _bin_pwr_ns %= 1000;
+    _samples = 0;
+}
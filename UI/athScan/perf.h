@@ -0,0 +1,76 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+/* counters shared by the ingestion threads and the GUI. They are only
+ * updated with atomic adds, the HUD takes and resets them periodically.
+ * The footprint of the sample store is a gauge, overwritten by the store
+ */
+struct perf_counters {
+    QAtomicInt samples;         /* decoded records */
+    QAtomicInt decode_us;       /* time spent decoding the records */
+    QAtomicInt bin_pwr_us;      /* time spent in compute_bin_pwr */
+    QAtomicInt paint_us;        /* time spent painting the canvas */
+    QAtomicInt frames;          /* painted frames */
+    QAtomicInt queued;          /* batches delivered, not yet consumed */
+    QAtomicInt dropped;         /* records dropped by a live source or the store */
+    QAtomicInt lost_frames;     /* frames lost by the capture agent */
+    QAtomicInt store_kb;        /* samples held in RAM by the store */
+    QAtomicInt spilled_kb;      /* samples spilled to disk by the store */
+};
+
+struct perf_counters *perf_stats();
+
+/* PerfProbe measures the decoding stages of an ingestion thread.
+ *
+ * The times are accumulated locally for every record and added to the
+ * shared counters by publish(), once per delivered batch, to keep the
+ * atomic operations out of the per record path.
+ */
+class PerfProbe
+{
+public:
+    PerfProbe();
+
+    inline void start();
+    inline void decoded();
+    inline void computed();
+    inline void resume();
+
+    void publish();
+
+private:
+    QElapsedTimer _clock;
+    qint64 _t0, _t1;
+    qint64 _samples, _decode_ns, _bin_pwr_ns;
+};
+
+/* to be called before decoding a record */
+inline void PerfProbe::start()
+{
+    _t0 = _clock.nsecsElapsed();
+}
+
+/* to be called after decoding a record */
+inline void PerfProbe::decoded()
+{
+    _t1 = _clock.nsecsElapsed();
+    _decode_ns += _t1 - _t0;
+}
+
+/* to be called after computing the bin powers of a record */
+inline void PerfProbe::computed()
+{
+    _bin_pwr_ns += _clock.nsecsElapsed() - _t1;
+    _samples++;
+}
+
+/* to be called after a pause between decoding and computing */
+inline void PerfProbe::resume()
+{
+    _t1 = _clock.nsecsElapsed();
+}
+
+#endif // PERF_H
@@ -0,0 +1,197 @@
+#include "recorder.h"
+#include "decoder.h"
+
+#include <string.h>
+
+PowerTrigger::PowerTrigger(float threshold) :
+    _threshold(threshold)
+{
+}
+
+bool PowerTrigger::fire(const fft_sample_tlv *, const QPointF *bins,
+                        qint32 num_bins)
+{
+    for (qint32 i = 0; i < num_bins; i++) {
+        if (bins[i].y() > _threshold)
+            return true;
+    }
+
+    return false;
+}
+
+MagnitudeTrigger::MagnitudeTrigger(quint16 threshold) :
+    _threshold(threshold)
+{
+}
+
+bool MagnitudeTrigger::fire(const fft_sample_tlv *tlv, const QPointF *, qint32)
+{
+    return tlv_decoder_lookup(tlv->type)->max_magnitude(tlv) > _threshold;
+}
+
+TriggerRecorder::TriggerRecorder(QString file_name) :
+    _file(file_name),
+    _error(0),
+    _pre_us(RECORDER_PRE_TRIGGER_MS * 1000ULL),
+    _post_us(RECORDER_POST_TRIGGER_MS * 1000ULL),
+    _head(0),
+    _flushed(0),
+    _last_tsf(0),
+    _recording(false),
+    _stop_tsf(0),
+    _events(0),
+    _written(0)
+{
+    _ring.resize(RECORDER_RING_SIZE);
+    _write_buffer.reserve(RECORDER_WRITE_CHUNK);
+}
+
+TriggerRecorder::~TriggerRecorder()
+{
+    flush();
+    _file.close();
+
+    qDeleteAll(_triggers);
+}
+
+/* ownership of the trigger is moved to the recorder */
+void TriggerRecorder::add_trigger(ScanTrigger *trigger)
+{
+    _triggers += trigger;
+}
+
+void TriggerRecorder::set_pre_trigger(quint32 ms)
+{
+    _pre_us = ms * 1000ULL;
+}
+
+void TriggerRecorder::set_post_trigger(quint32 ms)
+{
+    _post_us = ms * 1000ULL;
+}
+
+/* the content of the ring is dropped */
+void TriggerRecorder::set_ring_size(qint32 size)
+{
+    _ring.resize(size);
+    _records.clear();
+    _flushed = _head;
+}
+
+quint32 TriggerRecorder::events() const
+{
+    return _events;
+}
+
+qint64 TriggerRecorder::written() const
+{
+    return _written;
+}
+
+int TriggerRecorder::error() const
+{
+    return _error;
+}
+
+/* move the records of the ring not yet saved to the write buffer */
+void TriggerRecorder::copy_pending()
+{
+    if (!_records.isEmpty() && _records.head().offset > _flushed)
+        _flushed = _records.head().offset;
+
+    qint64 size = _ring.size();
+    while (_flushed < _head) {
+        qint64 pos = _flushed % size;
+        qint64 len = qMin(_head - _flushed, size - pos);
+
+        _write_buffer.append(_ring.constData() + pos, len);
+        _flushed += len;
+    }
+}
+
+/* write the pending data to the capture file */
+int TriggerRecorder::flush()
+{
+    if (_error < 0 || _write_buffer.isEmpty())
+        return _error;
+
+    if (!_file.isOpen() && !_file.open(QIODevice::WriteOnly)) {
+        _error = -1;
+        return _error;
+    }
+
+    if (_file.write(_write_buffer) != _write_buffer.size())
+        _error = -1;
+    else
+        _written += _write_buffer.size();
+
+    _write_buffer.resize(0);
+
+    return _error;
+}
+
+/* feed the recorder with the next record of the stream. raw is the
+ * record as received, sample its decoded copy
+ */
+int TriggerRecorder::push(const quint8 *raw, quint32 len,
+                          const fft_sample_tlv *sample,
+                          const QPointF *bins, qint32 num_bins)
+{
+    qint64 size = _ring.size();
+    if (_error < 0 || len > size)
+        return -1;
+
+    quint64 tsf = tlv_decoder_lookup(sample->type)->tsf(sample);
+
+    /* the TSF has been reset: the pending windows are closed */
+    if (tsf < _last_tsf) {
+        _records.clear();
+        _flushed = _head;
+        if (_recording) {
+            _recording = false;
+            flush();
+        }
+    }
+    _last_tsf = tsf;
+
+    /* room for the new record */
+    while (!_records.isEmpty() && _head + len - _records.head().offset > size)
+        _records.dequeue();
+
+    qint64 pos = _head % size;
+    qint64 part = qMin((qint64) len, size - pos);
+    memcpy(_ring.data() + pos, raw, part);
+    memcpy(_ring.data(), raw + part, len - part);
+
+    ring_record record = { _head, len, tsf };
+    _records.enqueue(record);
+    _head += len;
+
+    /* only the pre-trigger window is kept */
+    while (_records.head().tsf + _pre_us < tsf)
+        _records.dequeue();
+
+    bool fired = false;
+    for (qint32 i = 0; i < _triggers.size() && !fired; i++)
+        fired = _triggers[i]->fire(sample, bins, num_bins);
+
+    if (fired) {
+        if (!_recording)
+            _events++;
+        _recording = true;
+        _stop_tsf = tsf + _post_us;
+    } else if (_recording && tsf > _stop_tsf) {
+        /* end of the post-trigger window, this record is not saved */
+        _recording = false;
+
+        return flush();
+    }
+
+    if (_recording) {
+        copy_pending();
+        if (_write_buffer.size() >= RECORDER_WRITE_CHUNK)
+            return flush();
+    }
+
+    return _error;
+}
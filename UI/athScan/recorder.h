@@ -0,0 +1,114 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QQueue>
+#include <QPointF>
+
+struct fft_sample_tlv;
+
+/* default windows saved around a trigger */
+#define RECORDER_PRE_TRIGGER_MS     1000
+#define RECORDER_POST_TRIGGER_MS    1000
+/* default size of the pre-trigger ring */
+#define RECORDER_RING_SIZE          (32 * 1024 * 1024)
+/* size of the sequential writes to the capture */
+#define RECORDER_WRITE_CHUNK        (1024 * 1024)
+
+/* ScanTrigger decides if a sample is worth recording. Classifiers can be
+ * plugged in the recorder by subclassing it.
+ */
+class ScanTrigger
+{
+public:
+    virtual ~ScanTrigger() {}
+
+    /* bins holds the power of every bin of the decoded sample */
+    virtual bool fire(const fft_sample_tlv *, const QPointF *bins,
+                      qint32 num_bins) = 0;
+};
+
+/* fires when the power of any bin is above threshold [dbm] */
+class PowerTrigger : public ScanTrigger
+{
+public:
+    explicit PowerTrigger(float threshold);
+
+    virtual bool fire(const fft_sample_tlv *, const QPointF *, qint32);
+
+private:
+    float _threshold;
+};
+
+/* fires when the largest FFT magnitude is above threshold */
+class MagnitudeTrigger : public ScanTrigger
+{
+public:
+    explicit MagnitudeTrigger(quint16 threshold);
+
+    virtual bool fire(const fft_sample_tlv *, const QPointF *, qint32);
+
+private:
+    quint16 _threshold;
+};
+
+/* TriggerRecorder saves the interesting parts of a capture.
+ *
+ * The raw records of the last pre-trigger window are kept in a memory
+ * ring. When a trigger fires, the ring and then every record up to the
+ * end of the post-trigger window (extended by new triggers) are copied
+ * to a write buffer, flushed to the capture file in large sequential
+ * chunks. The output holds the records as received, so it can be
+ * loaded back like any other capture. Times are taken from the TSF of
+ * the samples.
+ */
+class TriggerRecorder
+{
+public:
+    explicit TriggerRecorder(QString file_name);
+    ~TriggerRecorder();
+
+    void add_trigger(ScanTrigger *);
+    void set_pre_trigger(quint32 ms);
+    void set_post_trigger(quint32 ms);
+    void set_ring_size(qint32 size);
+
+    int push(const quint8 *raw, quint32 len, const fft_sample_tlv *sample,
+             const QPointF *bins, qint32 num_bins);
+    int flush();
+
+    quint32 events() const;
+    qint64 written() const;
+    int error() const;
+
+private:
+    struct ring_record {
+        qint64 offset;  /* position in the stream of the ring */
+        quint32 len;
+        quint64 tsf;
+    };
+
+    void copy_pending();
+
+    QFile _file;
+    int _error;
+
+    QList<ScanTrigger *> _triggers;
+    quint64 _pre_us, _post_us;
+
+    QByteArray _ring;
+    QQueue<ring_record> _records;
+    qint64 _head, _flushed;
+    quint64 _last_tsf;
+
+    bool _recording;
+    quint64 _stop_tsf;
+    quint32 _events;
+
+    QByteArray _write_buffer;
+    qint64 _written;
+};
+
+#endif // RECORDER_H
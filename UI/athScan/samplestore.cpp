@@ -0,0 +1,528 @@
+#include "samplestore.h"
+#include "decoder.h"
+#include "perf.h"
+
+#include <QDir>
+#include <QTemporaryFile>
+
+SampleStore::SampleStore() :
+    _budget(STORE_DEFAULT_BUDGET),
+    _error(0),
+    _spill_file(NULL),
+    _records(0),
+    _memory(0),
+    _spilled(0),
+    _clock(0)
+{
+    _current.records = 0;
+}
+
+SampleStore::~SampleStore()
+{
+    delete _spill_file;
+}
+
+/* cold segments are paged out when the records held in RAM, plain or
+ * compressed, exceed bytes
+ */
+void SampleStore::set_budget(qint64 bytes)
+{
+    QMutexLocker locker(&_mutex);
+
+    _budget = qMax(bytes, (qint64) STORE_SEGMENT_SIZE);
+    page_out();
+    update_stats();
+}
+
+qint64 SampleStore::budget() const
+{
+    QMutexLocker locker(&_mutex);
+
+    return _budget;
+}
+
+/* append a decoded record of len bytes, freq is its center frequency */
+int SampleStore::append(const fft_sample_tlv *sample, quint32 len, quint16 freq)
+{
+    quint64 tsf = tlv_decoder_lookup(sample->type)->tsf(sample);
+
+    QMutexLocker locker(&_mutex);
+
+    if (_current.records > 0 &&
+        _current.data.size() + len > STORE_SEGMENT_SIZE) {
+        seal_current();
+        update_stats();
+    }
+
+    if (_current.records == 0) {
+        _current.state = SEGMENT_HOT;
+        _current.file_offset = -1;
+        _current.file_len = 0;
+        _current.min_freq = _current.max_freq = freq;
+        _current.min_tsf = _current.max_tsf = tsf;
+        _current.data.reserve(STORE_SEGMENT_SIZE);
+    }
+
+    _current.data.append((const char *) sample, len);
+    _current.records++;
+    _current.min_freq = qMin(_current.min_freq, (quint32) freq);
+    _current.max_freq = qMax(_current.max_freq, (quint32) freq);
+    _current.min_tsf = qMin(_current.min_tsf, tsf);
+    _current.max_tsf = qMax(_current.max_tsf, tsf);
+    _current.last_use = ++_clock;
+
+    _records++;
+    _memory += len;
+    if (_memory > _budget)
+        page_out();
+
+    return 0;
+}
+
+/* close the segment being filled, so that the next records start a new
+ * one. Returns the number of sealed segments, to be given to truncate()
+ * to drop the records appended after this call
+ */
+qint32 SampleStore::seal()
+{
+    QMutexLocker locker(&_mutex);
+
+    seal_current();
+
+    return _segments.size();
+}
+
+void SampleStore::truncate(qint32 num_segments)
+{
+    QMutexLocker locker(&_mutex);
+
+    _records -= _current.records;
+    _memory -= _current.data.size();
+    _current.data = QByteArray();
+    _current.records = 0;
+
+    while (_segments.size() > qMax(num_segments, 0)) {
+        const store_segment &segment = _segments.last();
+
+        QMap<quint64, qint32> *queue = lru_queue(segment.state);
+        if (queue)
+            queue->remove(segment.last_use);
+
+        if (segment.file_offset >= 0)
+            release_range(segment.file_offset, segment.file_len);
+
+        _records -= segment.records;
+        if (segment.state == SEGMENT_SPILLED)
+            _spilled -= segment.file_len;
+        else
+            _memory -= segment.data.size();
+
+        _segments.removeLast();
+    }
+
+    update_stats();
+}
+
+void SampleStore::clear()
+{
+    QMutexLocker locker(&_mutex);
+
+    _segments.clear();
+    _hot_lru.clear();
+    _compressed_lru.clear();
+    _current.data = QByteArray();
+    _current.records = 0;
+
+    delete _spill_file;
+    _spill_file = NULL;
+    _free_ranges.clear();
+
+    _records = _memory = _spilled = 0;
+    _error = 0;
+
+    update_stats();
+}
+
+/* publish the footprint of the store for the HUD. Must be called with
+ * the lock held
+ */
+void SampleStore::update_stats()
+{
+    perf_counters *stats = perf_stats();
+
+    stats->store_kb.store(_memory / 1024);
+    stats->spilled_kb.store(_spilled / 1024);
+}
+
+/* must be called with the lock held */
+void SampleStore::seal_current()
+{
+    if (_current.records == 0)
+        return;
+
+    _current.data.squeeze();
+    _segments.append(_current);
+    _hot_lru.insert(_current.last_use, _segments.size() - 1);
+
+    _current.data = QByteArray();
+    _current.records = 0;
+}
+
+/* queue of the segments in state, NULL for the states not paged out.
+ * Must be called with the lock held
+ */
+QMap<quint64, qint32> *SampleStore::lru_queue(segment_state state)
+{
+    switch (state) {
+    case SEGMENT_HOT:
+        return &_hot_lru;
+    case SEGMENT_COMPRESSED:
+        return &_compressed_lru;
+    default:
+        return NULL;
+    }
+}
+
+/* compress the least recently used plain segments, then spill the least
+ * recently used compressed ones, until the budget is met. Once spilling
+ * failed, the compressed segments not in the file yet are dropped. Must
+ * be called with the lock held
+ */
+void SampleStore::page_out()
+{
+    while (_memory > _budget) {
+        if (!_hot_lru.isEmpty()) {
+            QMap<quint64, qint32>::iterator it = _hot_lru.begin();
+            qint32 idx = it.value();
+            _hot_lru.erase(it);
+
+            store_segment &segment = _segments[idx];
+            QByteArray data = qCompress(segment.data, STORE_COMPRESS_LEVEL);
+
+            _memory += data.size() - segment.data.size();
+            segment.data = data;
+            segment.state = SEGMENT_COMPRESSED;
+            _compressed_lru.insert(segment.last_use, idx);
+        } else if (!_compressed_lru.isEmpty()) {
+            QMap<quint64, qint32>::iterator it = _compressed_lru.begin();
+            qint32 idx = it.value();
+            _compressed_lru.erase(it);
+
+            store_segment &segment = _segments[idx];
+            if ((segment.file_offset < 0 && _error) || spill(segment) < 0)
+                drop(segment);
+        } else {
+            /* only the segment being filled is left */
+            return;
+        }
+    }
+}
+
+/* must be called with the lock held */
+int SampleStore::spill(store_segment &segment)
+{
+    if (segment.file_offset < 0) {
+        if (!_spill_file) {
+            _spill_file = new QTemporaryFile(QDir::tempPath() + "/athScan-XXXXXX.spill");
+            if (!_spill_file->open()) {
+                delete _spill_file;
+                _spill_file = NULL;
+                _error = -1;
+                return -1;
+            }
+        }
+
+        qint64 offset = allocate_range(segment.data.size());
+        if (!_spill_file->seek(offset) ||
+            _spill_file->write(segment.data) != segment.data.size() ||
+            !_spill_file->flush()) {
+            _error = -1;
+            return -1;
+        }
+
+        segment.file_offset = offset;
+        segment.file_len = segment.data.size();
+    }
+
+    /* a segment paged in keeps its copy in the file */
+    _memory -= segment.data.size();
+    _spilled += segment.file_len;
+    segment.data = QByteArray();
+    segment.state = SEGMENT_SPILLED;
+
+    return 0;
+}
+
+/* give up the records of a segment that can't be spilled. Must be called
+ * with the lock held
+ */
+void SampleStore::drop(store_segment &segment)
+{
+    perf_stats()->dropped.fetchAndAddRelaxed(segment.records);
+
+    _records -= segment.records;
+    _memory -= segment.data.size();
+    segment.data = QByteArray();
+    segment.records = 0;
+    segment.state = SEGMENT_DROPPED;
+}
+
+/* offset of len bytes in the spill file, the first free range large
+ * enough or the end of the file. Must be called with the lock held
+ */
+qint64 SampleStore::allocate_range(qint32 len)
+{
+    for (qint32 i = 0; i < _free_ranges.size(); i++) {
+        store_range &range = _free_ranges[i];
+        if (range.len < len)
+            continue;
+
+        qint64 offset = range.offset;
+        range.offset += len;
+        range.len -= len;
+        if (range.len == 0)
+            _free_ranges.remove(i);
+
+        return offset;
+    }
+
+    return _spill_file->size();
+}
+
+/* the ranges are merged with their neighbours, the file is shrunk when
+ * its tail is free. Must be called with the lock held
+ */
+void SampleStore::release_range(qint64 offset, qint32 len)
+{
+    if (!_spill_file || len <= 0)
+        return;
+
+    qint32 i = 0;
+    while (i < _free_ranges.size() && _free_ranges[i].offset < offset)
+        i++;
+
+    store_range range;
+    range.offset = offset;
+    range.len = len;
+    _free_ranges.insert(i, range);
+
+    if (i + 1 < _free_ranges.size() &&
+        _free_ranges[i].offset + _free_ranges[i].len == _free_ranges[i + 1].offset) {
+        _free_ranges[i].len += _free_ranges[i + 1].len;
+        _free_ranges.remove(i + 1);
+    }
+    if (i > 0 &&
+        _free_ranges[i - 1].offset + _free_ranges[i - 1].len == _free_ranges[i].offset) {
+        _free_ranges[i - 1].len += _free_ranges[i].len;
+        _free_ranges.remove(i);
+    }
+
+    const store_range &last = _free_ranges.last();
+    if (last.offset + last.len >= _spill_file->size()) {
+        _spill_file->resize(last.offset);
+        _free_ranges.removeLast();
+    }
+}
+
+/* give the stored form of the segment idx, -1 for the segment being
+ * filled, in data. A spilled segment is read back and kept compressed in
+ * RAM until it is paged out again. Must be called with the lock held
+ */
+int SampleStore::page_in(qint32 idx, QByteArray &data)
+{
+    store_segment &segment = (idx < 0) ? _current : _segments[idx];
+
+    QMap<quint64, qint32> *queue = (idx < 0) ? NULL : lru_queue(segment.state);
+    if (queue)
+        queue->remove(segment.last_use);
+    segment.last_use = ++_clock;
+
+    if (segment.state == SEGMENT_SPILLED) {
+        if (!_spill_file || !_spill_file->seek(segment.file_offset))
+            return -1;
+
+        data = _spill_file->read(segment.file_len);
+        if (data.size() != segment.file_len)
+            return -1;
+
+        segment.data = data;
+        segment.state = SEGMENT_COMPRESSED;
+        _spilled -= segment.file_len;
+        _memory += segment.data.size();
+        queue = &_compressed_lru;
+    } else {
+        data = segment.data;
+    }
+
+    if (queue)
+        queue->insert(segment.last_use, idx);
+
+    return 0;
+}
+
+/* append to bins the power of every bin of the records selected by query,
+ * newest segments first, until max_bins are collected. The records are
+ * decompressed outside of the lock, so that the ingestion threads are not
+ * held back by a large query. The query stops at the next segment once
+ * cancel is set. Returns the number of records, -1 on error
+ */
+int SampleStore::collect(const store_query &query, QPolygonF &bins, qint32 max_bins,
+                         const QAtomicInt *cancel)
+{
+    qint32 first_bin = bins.size();
+    qint32 num_segments = 0;
+    int num_records = 0;
+
+    for (qint32 i = -1; bins.size() - first_bin < max_bins; i++) {
+        QByteArray data;
+        bool compressed;
+
+        if (cancel && cancel->load() != 0)
+            break;
+
+        {
+            QMutexLocker locker(&_mutex);
+
+            /* the segment being filled comes first. The count is taken
+             * with it: once sealed by an ingestion thread it must not
+             * be visited again
+             */
+            if (i < 0)
+                num_segments = _segments.size();
+            qint32 idx = num_segments - 1 - i;
+            if (idx < qMax(query.first_segment, 0) || (i >= 0 && idx >= _segments.size()))
+                break;
+            store_segment *segment = (i < 0) ? &_current : &_segments[idx];
+
+            if (segment->records == 0 ||
+                segment->max_freq + STORE_FREQ_MARGIN < query.min_freq ||
+                segment->min_freq > query.max_freq + STORE_FREQ_MARGIN ||
+                segment->max_tsf < query.min_tsf || segment->min_tsf > query.max_tsf)
+                continue;
+
+            compressed = (segment->state != SEGMENT_HOT);
+            if (page_in((i < 0) ? -1 : idx, data) < 0) {
+                _error = -1;
+                return -1;
+            }
+
+            if (_memory > _budget)
+                page_out();
+            update_stats();
+        }
+
+        if (compressed) {
+            data = qUncompress(data);
+            if (data.isEmpty())
+                return -1;
+        }
+
+        const quint8 *ptr = (const quint8 *) data.constData();
+        qint32 size = data.size();
+        qint32 pos = 0;
+        while (pos + (qint32) sizeof(fft_sample_tlv) <= size) {
+            const fft_sample_tlv *tlv = (const fft_sample_tlv *) (ptr + pos);
+            const tlv_decoder *decoder = tlv_decoder_lookup(tlv->type);
+
+            /* decoded records hold their length in host order */
+            pos += sizeof(fft_sample_tlv) + tlv->length;
+            if (!decoder || pos > size)
+                return -1;
+
+            quint64 tsf = decoder->tsf(tlv);
+            if (tsf < query.min_tsf || tsf > query.max_tsf)
+                continue;
+
+            qint32 record_first = bins.size();
+            decoder->bin_pwr(tlv, bins);
+
+            /* the frequency range applies to the bins, records of a wide
+             * channel can be partially selected
+             */
+            qint32 k = record_first;
+            for (qint32 j = record_first; j < bins.size(); j++) {
+                if (bins[j].x() >= query.min_freq && bins[j].x() <= query.max_freq)
+                    bins[k++] = bins[j];
+            }
+            if (k > record_first)
+                num_records++;
+            bins.resize(k);
+        }
+    }
+
+    return num_records;
+}
+
+qint64 SampleStore::records() const
+{
+    QMutexLocker locker(&_mutex);
+
+    return _records;
+}
+
+/* bytes of records held in RAM */
+qint64 SampleStore::memory() const
+{
+    QMutexLocker locker(&_mutex);
+
+    return _memory;
+}
+
+/* bytes of records held in the spill file */
+qint64 SampleStore::spilled() const
+{
+    QMutexLocker locker(&_mutex);
+
+    return _spilled;
+}
+
+int SampleStore::error() const
+{
+    QMutexLocker locker(&_mutex);
+
+    return _error;
+}
+
+StoreReader::StoreReader(SampleStore *store, const store_query &query,
+                         qint32 max_bins, QObject *parent) :
+    QThread(parent),
+    _store(store),
+    _query(query),
+    _max_bins(max_bins),
+    _cancel(0),
+    _error(0)
+{
+}
+
+StoreReader::~StoreReader()
+{
+    cancel();
+    wait();
+}
+
+void StoreReader::cancel()
+{
+    _cancel.store(1);
+}
+
+bool StoreReader::cancelled() const
+{
+    return _cancel.load() != 0;
+}
+
+int StoreReader::error() const
+{
+    return _error;
+}
+
+/* to be called once finished */
+QPolygonF StoreReader::bins() const
+{
+    return _bins;
+}
+
+void StoreReader::run()
+{
+    if (_store->collect(_query, _bins, _max_bins, &_cancel) < 0)
+        _error = -1;
+}
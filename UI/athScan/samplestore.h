@@ -0,0 +1,154 @@
+#ifndef SAMPLESTORE_H
+#define SAMPLESTORE_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QPolygonF>
+#include <QThread>
+#include <QVector>
+
+struct fft_sample_tlv;
+class QTemporaryFile;
+
+/* decoded records held by a segment */
+#define STORE_SEGMENT_SIZE      (256 * 1024)
+/* default RAM budget of the store */
+#define STORE_DEFAULT_BUDGET    (256LL * 1024 * 1024)
+/* largest distance [MHz] between a bin and the center frequency */
+#define STORE_FREQ_MARGIN       80
+/* compression level of the cold segments, see qCompress() */
+#define STORE_COMPRESS_LEVEL    1
+
+/* selection of the records of the store, the ranges are inclusive */
+struct store_query {
+    qint32 first_segment;           /* see SampleStore::seal() */
+    quint32 min_freq, max_freq;     /* frequency of the bins [MHz] */
+    quint64 min_tsf, max_tsf;       /* timestamp [us] */
+};
+
+/* SampleStore keeps the decoded samples of a session within a RAM budget.
+ *
+ * Records are appended to fixed-size segments. Once sealed, a segment is
+ * immutable and moves through three states as the budget requires: hot
+ * (plain in RAM), compressed (in RAM) and spilled (compressed in a
+ * temporary file). The least recently used segments are compressed
+ * first, then spilled. Segments are paged back when a query needs them:
+ * every segment keeps the frequency and TSF range of its records, so the
+ * segments outside a query are never touched. A spilled segment paged
+ * back is kept compressed in RAM and keeps its place in the file, paging
+ * it out again only drops the RAM copy. The ranges of the truncated
+ * segments are reused by the next spills.
+ *
+ * Once the spill file can't be written, the least recently used
+ * compressed segments are dropped instead, so that the budget is still
+ * met. Their records are counted as dropped by the HUD and error()
+ * reports the failure.
+ *
+ * The store is shared by the ingestion threads and the GUI, every
+ * method is thread safe.
+ */
+class SampleStore
+{
+public:
+    SampleStore();
+    ~SampleStore();
+
+    void set_budget(qint64 bytes);
+    qint64 budget() const;
+
+    int append(const fft_sample_tlv *sample, quint32 len, quint16 freq);
+    qint32 seal();
+    void truncate(qint32 num_segments);
+    void clear();
+
+    int collect(const store_query &, QPolygonF &bins, qint32 max_bins,
+                const QAtomicInt *cancel = NULL);
+
+    qint64 records() const;
+    qint64 memory() const;
+    qint64 spilled() const;
+    int error() const;
+
+private:
+    enum segment_state {
+        SEGMENT_HOT,
+        SEGMENT_COMPRESSED,
+        SEGMENT_SPILLED,
+        SEGMENT_DROPPED
+    };
+
+    struct store_segment {
+        segment_state state;
+        QByteArray data;            /* plain or compressed records */
+        qint64 file_offset;         /* -1 until written to the spill file */
+        qint32 file_len;
+        quint32 records;
+        quint32 min_freq, max_freq;
+        quint64 min_tsf, max_tsf;
+        quint64 last_use;
+    };
+
+    /* range of the spill file no longer used by a segment */
+    struct store_range {
+        qint64 offset;
+        qint32 len;
+    };
+
+    void seal_current();
+    void page_out();
+    void update_stats();
+    QMap<quint64, qint32> *lru_queue(segment_state);
+    int page_in(qint32, QByteArray &);
+    int spill(store_segment &);
+    void drop(store_segment &);
+    qint64 allocate_range(qint32 len);
+    void release_range(qint64 offset, qint32 len);
+
+    mutable QMutex _mutex;
+    qint64 _budget;
+    int _error;
+
+    QVector<store_segment> _segments;
+    store_segment _current;
+    /* index of the hot and compressed segments by last use */
+    QMap<quint64, qint32> _hot_lru, _compressed_lru;
+
+    QTemporaryFile *_spill_file;
+    QVector<store_range> _free_ranges;      /* sorted by offset */
+    qint64 _records, _memory, _spilled;
+    quint64 _clock;
+};
+
+/* StoreReader runs SampleStore::collect() in a worker thread, so that
+ * paging back and decompressing the segments of a large query doesn't
+ * block the GUI. The bins are taken with bins() once finished.
+ */
+class StoreReader : public QThread
+{
+    Q_OBJECT
+
+public:
+    StoreReader(SampleStore *store, const store_query &query, qint32 max_bins,
+                QObject *parent = 0);
+    ~StoreReader();
+
+    void cancel();
+    bool cancelled() const;
+    int error() const;
+    QPolygonF bins() const;
+
+protected:
+    virtual void run();
+
+private:
+    SampleStore *_store;
+    store_query _query;
+    qint32 _max_bins;
+    QAtomicInt _cancel;
+    int _error;
+    QPolygonF _bins;
+};
+
+#endif // SAMPLESTORE_H
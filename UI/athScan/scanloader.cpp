@@ -0,0 +1,246 @@
+#include "scanloader.h"
+
+#include "decoder.h"
+#include "recorder.h"
+#include "samplestore.h"
+#include "perf.h"
+
+#include <QFile>
+#include <QElapsedTimer>
+
+#include <qwt_trace.h>
+
+ScanLoader::ScanLoader(QString file_name, QObject *parent) :
+    QThread(parent),
+    _file_name(file_name),
+    _cancel(0),
+    _error(0),
+    _store(NULL),
+    _min_freq(~0),
+    _max_freq(0),
+    _recorder(NULL)
+{
+}
+
+ScanLoader::~ScanLoader()
+{
+    cancel();
+    wait();
+}
+
+void ScanLoader::cancel()
+{
+    _cancel.store(1);
+}
+
+bool ScanLoader::cancelled() const
+{
+    return _cancel.load() != 0;
+}
+
+int ScanLoader::error() const
+{
+    return _error;
+}
+
+/* the recorder is used by the loader thread until it is finished */
+void ScanLoader::set_recorder(TriggerRecorder *recorder)
+{
+    _recorder = recorder;
+}
+
+quint32 ScanLoader::min_freq() const
+{
+    return _min_freq;
+}
+
+quint32 ScanLoader::max_freq() const
+{
+    return _max_freq;
+}
+
+/* the decoded samples are appended to store, used by the loader thread
+ * until it is finished
+ */
+void ScanLoader::set_store(SampleStore *store)
+{
+    _store = store;
+}
+
+/* the samples are checked against mask, to be set before the start */
+void ScanLoader::set_mask(const SpectralMask &mask)
+{
+    _mask.set_mask(mask);
+}
+
+/* copy the TLV at ptr in dst, see tlv_decoder */
+static quint16 decode_sample(const quint8 *ptr, quint32 len, quint8 *dst)
+{
+    const fft_sample_tlv *tlv = (const fft_sample_tlv *) ptr;
+
+    return tlv_decoder_lookup(tlv->type)->decode(ptr, len, dst);
+}
+
+/* decode a coarse subsample of the capture. Record boundaries are not
+ * known at an arbitrary offset, so each probe looks for the first
+ * position holding a valid TLV that is followed by another valid TLV
+ * (or by the end of the file)
+ */
+int ScanLoader::load_preview(const quint8 *buffer, qint64 size)
+{
+    quint32 min_freq = ~0, max_freq = 0;
+    quint8 sample[SCAN_MAX_SAMPLE_LEN];
+    qint64 last = -1;
+    QPolygonF preview;
+
+    for (qint32 k = 0; k < SCAN_PREVIEW_PROBES; k++) {
+        if (cancelled())
+            return -1;
+
+        qint64 end = size * (k + 1) / SCAN_PREVIEW_PROBES;
+        for (qint64 i = size * k / SCAN_PREVIEW_PROBES; i < end; i++) {
+            qint32 len = tlv_sample_len(buffer + i, size - i);
+            if (len < 0)
+                continue;
+            if (i + len < size && tlv_sample_len(buffer + i + len, size - i - len) < 0)
+                continue;
+
+            /* small files: do not decode the same record twice */
+            if (i <= last)
+                break;
+            last = i;
+
+            quint16 freq = decode_sample(buffer + i, len, sample);
+            if (freq < min_freq)
+                min_freq = freq;
+            if (freq > max_freq)
+                max_freq = freq;
+
+            AthScan::compute_bin_pwr((fft_sample_tlv *) sample, preview);
+            break;
+        }
+    }
+
+    /* an empty capture is an empty load, not a parse error */
+    if (preview.isEmpty())
+        return (size == 0) ? 0 : -1;
+
+    emit preview_ready(preview, min_freq - 40, max_freq + 40);
+
+    return 0;
+}
+
+int ScanLoader::load_samples(const quint8 *buffer, qint64 size)
+{
+    quint8 sample[SCAN_MAX_SAMPLE_LEN];
+    fft_sample_tlv *tlv = (fft_sample_tlv *) sample;
+    QElapsedTimer timer;
+    QPolygonF batch;
+    PerfProbe probe;
+    qint64 i = 0;
+
+    timer.start();
+    while (i < size) {
+        if (cancelled())
+            return -1;
+
+        qint32 len = tlv_sample_len(buffer + i, size - i);
+        if (len < 0)
+            return -1;
+
+        probe.start();
+        quint16 freq;
+        {
+            QWT_TRACE_SCOPE("TLV parse", "athscan");
+            freq = decode_sample(buffer + i, len, sample);
+        }
+        probe.decoded();
+
+        /* compute boundaries */
+        if (freq < _min_freq)
+            _min_freq = freq;
+        if (freq > _max_freq)
+            _max_freq = freq;
+
+        qint32 first_bin = batch.size();
+        {
+            QWT_TRACE_SCOPE("power compute", "athscan");
+            AthScan::compute_bin_pwr(tlv, batch);
+        }
+        probe.computed();
+        if (_store)
+            _store->append(tlv, len, freq);
+        if (_mask.is_active())
+            _mask.check(batch.constData() + first_bin, batch.size() - first_bin,
+                        tlv_decoder_lookup(tlv->type)->tsf(tlv));
+        if (_recorder)
+            _recorder->push(buffer + i, len, tlv,
+                            batch.constData() + first_bin, batch.size() - first_bin);
+        _panorama.add_sample(tlv);
+
+        i += len;
+
+        if (timer.elapsed() >= SCAN_BATCH_INTERVAL_MS) {
+            probe.publish();
+            perf_stats()->queued.ref();
+            emit samples_ready(batch);
+            emit panorama_ready(_panorama);
+            _panorama.clear();
+            if (_mask.is_active()) {
+                emit mask_ready(_mask);
+                _mask.clear();
+            }
+            emit progress((int) (100 * i / size));
+            batch.clear();
+            timer.restart();
+        }
+    }
+
+    if (_recorder)
+        _recorder->flush();
+
+    probe.publish();
+    if (!batch.isEmpty()) {
+        perf_stats()->queued.ref();
+        emit samples_ready(batch);
+        emit panorama_ready(_panorama);
+        _panorama.clear();
+        if (_mask.is_active()) {
+            emit mask_ready(_mask);
+            _mask.clear();
+        }
+    }
+    emit progress(100);
+
+    return 0;
+}
+
+void ScanLoader::run()
+{
+    QFile scan_file(_file_name);
+
+    if (!scan_file.open(QIODevice::ReadOnly)) {
+        _error = -1;
+        return;
+    }
+
+    /* map the capture to avoid copying it before the first frame */
+    QByteArray buffer;
+    qint64 size = scan_file.size();
+    const quint8 *data;
+    {
+        QWT_TRACE_SCOPE("file read", "athscan");
+        data = scan_file.map(0, size);
+        if (!data) {
+            buffer = scan_file.readAll();
+            data = (const quint8 *) buffer.constData();
+            size = buffer.size();
+        }
+    }
+
+    if (load_preview(data, size) < 0 ||
+        load_samples(data, size) < 0)
+        _error = -1;
+
+    scan_file.close();
+}
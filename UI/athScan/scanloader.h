@@ -0,0 +1,77 @@
+#ifndef SCANLOADER_H
+#define SCANLOADER_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QPolygonF>
+
+#include "athscan.h"
+#include "panorama.h"
+#include "mask.h"
+
+/* number of evenly spaced records decoded for the coarse preview */
+#define SCAN_PREVIEW_PROBES     4096
+/* minimum interval between two partial deliveries of the full pass */
+#define SCAN_BATCH_INTERVAL_MS  250
+
+/* ScanLoader parses a spectral capture in a worker thread.
+ *
+ * Loading is done in two passes: the preview pass decodes a coarse
+ * subsample picked at evenly spaced file offsets (resynchronizing on the
+ * next valid TLV header) so the first frame is available almost
+ * immediately, then the full pass walks every record and hands the
+ * computed bin powers over in batches. Decoded samples are appended to
+ * the store set with set_store().
+ * Along with every batch, the samples are stitched on the panorama grid
+ * and the cells they modified are handed over with panorama_ready().
+ * When a recorder is set, every record is fed to it by the full pass.
+ * When a mask is set, the violations of every batch are handed over
+ * with mask_ready().
+ */
+class TriggerRecorder;
+class SampleStore;
+
+class ScanLoader : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit ScanLoader(QString file_name, QObject *parent = 0);
+    ~ScanLoader();
+
+    void cancel();
+    bool cancelled() const;
+    int error() const;
+    void set_recorder(TriggerRecorder *);
+    void set_store(SampleStore *);
+    void set_mask(const SpectralMask &);
+
+    quint32 min_freq() const;
+    quint32 max_freq() const;
+
+signals:
+    void progress(int percent);
+    void preview_ready(QPolygonF samples, int min_freq, int max_freq);
+    void samples_ready(QPolygonF samples);
+    void panorama_ready(SpectrumPanorama panorama);
+    void mask_ready(MaskViolations violations);
+
+protected:
+    virtual void run();
+
+private:
+    int load_preview(const quint8 *, qint64);
+    int load_samples(const quint8 *, qint64);
+
+    QString _file_name;
+    QAtomicInt _cancel;
+    int _error;
+
+    SampleStore *_store;
+    quint32 _min_freq, _max_freq;
+    SpectrumPanorama _panorama;
+    MaskViolations _mask;
+    TriggerRecorder *_recorder;
+};
+
+#endif // SCANLOADER_H
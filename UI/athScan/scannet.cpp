@@ -0,0 +1,296 @@
+#include "scannet.h"
+#include "decoder.h"
+#include "recorder.h"
+#include "samplestore.h"
+#include "scanproto.h"
+
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include <QtEndian>
+
+#include <qwt_trace.h>
+
+ScanNetSource::ScanNetSource(QString address, QObject *parent) :
+    QThread(parent),
+    _address(address),
+    _recorder(NULL),
+    _cancel(0),
+    _error(0),
+    _store(NULL),
+    _min_freq(~0),
+    _max_freq(0),
+    _records(0),
+    _frames(0),
+    _lost(0),
+    _bytes(0)
+{
+}
+
+ScanNetSource::~ScanNetSource()
+{
+    cancel();
+    wait();
+}
+
+void ScanNetSource::set_recorder(TriggerRecorder *recorder)
+{
+    _recorder = recorder;
+}
+
+void ScanNetSource::cancel()
+{
+    _cancel.store(1);
+}
+
+bool ScanNetSource::cancelled() const
+{
+    return _cancel.load() != 0;
+}
+
+int ScanNetSource::error() const
+{
+    return _error;
+}
+
+quint32 ScanNetSource::min_freq() const
+{
+    return _min_freq;
+}
+
+quint32 ScanNetSource::max_freq() const
+{
+    return _max_freq;
+}
+
+/* the received samples are appended to store, used by the receiving
+ * thread until it is finished
+ */
+void ScanNetSource::set_store(SampleStore *store)
+{
+    _store = store;
+}
+
+/* the samples are checked against mask, to be set before the start */
+void ScanNetSource::set_mask(const SpectralMask &mask)
+{
+    _mask.set_mask(mask);
+}
+
+static bool is_connected(QIODevice *dev)
+{
+    QAbstractSocket *tcp = qobject_cast<QAbstractSocket *>(dev);
+    if (tcp)
+        return tcp->state() == QAbstractSocket::ConnectedState;
+
+    QLocalSocket *local = qobject_cast<QLocalSocket *>(dev);
+    return local && local->state() == QLocalSocket::ConnectedState;
+}
+
+/* read exactly len bytes, -1 on cancel or end of the stream */
+int ScanNetSource::read_full(QIODevice *dev, char *data, qint64 len)
+{
+    while (len > 0) {
+        if (cancelled())
+            return -1;
+
+        qint64 n = dev->read(data, len);
+        if (n < 0)
+            return -1;
+
+        if (n == 0 && !dev->waitForReadyRead(100) &&
+            dev->bytesAvailable() == 0 && !is_connected(dev))
+            return -1;
+
+        data += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+void ScanNetSource::deliver()
+{
+    if (_batch.isEmpty())
+        return;
+
+    _probe.publish();
+    perf_stats()->queued.ref();
+    emit samples_ready(_batch);
+    emit panorama_ready(_panorama);
+    if (_mask.is_active())
+        emit mask_ready(_mask);
+
+    _batch.clear();
+    _panorama.clear();
+    _mask.clear();
+}
+
+int ScanNetSource::decode_frame(const quint8 *buffer, qint64 size)
+{
+    quint8 sample[SCAN_MAX_SAMPLE_LEN];
+    fft_sample_tlv *tlv = (fft_sample_tlv *) sample;
+    qint64 i = 0;
+
+    while (i < size) {
+        /* the record length is unknown: the rest of the frame is
+         * dropped and accounted as lost, the session goes on with the
+         * next frame
+         */
+        qint32 len = tlv_sample_len(buffer + i, size - i);
+        if (len < 0) {
+            _lost++;
+            perf_stats()->lost_frames.fetchAndAddRelaxed(1);
+            break;
+        }
+
+        const tlv_decoder *decoder = tlv_decoder_lookup(buffer[i]);
+
+        _probe.start();
+        quint16 freq;
+        {
+            QWT_TRACE_SCOPE("TLV parse", "athscan");
+            freq = decoder->decode(buffer + i, len, sample);
+        }
+        _probe.decoded();
+        if (freq < _min_freq)
+            _min_freq = freq;
+        if (freq > _max_freq)
+            _max_freq = freq;
+
+        qint32 first_bin = _batch.size();
+        {
+            QWT_TRACE_SCOPE("power compute", "athscan");
+            decoder->bin_pwr(tlv, _batch);
+        }
+        _probe.computed();
+        if (_store)
+            _store->append(tlv, len, freq);
+        if (_mask.is_active())
+            _mask.check(_batch.constData() + first_bin, _batch.size() - first_bin,
+                        decoder->tsf(tlv));
+        _panorama.add_sample(tlv);
+        if (_recorder)
+            _recorder->push(buffer + i, len, tlv,
+                            _batch.constData() + first_bin, _batch.size() - first_bin);
+
+        _records++;
+        i += len;
+    }
+
+    return 0;
+}
+
+int ScanNetSource::receive(QIODevice *dev)
+{
+    qint64 next_batch = SCAN_NET_BATCH_MS;
+    qint64 next_report = SCAN_NET_REPORT_MS;
+    quint32 expected = 0;
+
+    _clock.start();
+    while (!cancelled()) {
+        scan_frame_hdr hdr;
+
+        if (read_full(dev, (char *) &hdr, sizeof(hdr)) < 0)
+            break;
+
+        quint32 len = qFromBigEndian((quint32) hdr.len);
+        quint32 raw_len = qFromBigEndian((quint32) hdr.raw_len);
+        quint32 seq = qFromBigEndian((quint32) hdr.seq);
+
+        if (qFromBigEndian((quint32) hdr.magic) != SCAN_FRAME_MAGIC ||
+            hdr.version != SCAN_FRAME_VERSION ||
+            len > SCAN_FRAME_MAX_LEN || raw_len > SCAN_FRAME_MAX_LEN)
+            return -1;
+
+        /* the header read waits for the agent, only the payload is
+         * traced
+         */
+        _payload.resize(len);
+        {
+            QWT_TRACE_SCOPE_ARG("frame read", "athscan", "bytes", (int) len);
+            if (read_full(dev, _payload.data(), len) < 0)
+                break;
+        }
+
+        /* frames skipped by the agent */
+        if (_frames > 0 && seq != expected) {
+            _lost += (quint32) (seq - expected);
+            perf_stats()->lost_frames.fetchAndAddRelaxed(seq - expected);
+        }
+        expected = seq + 1;
+        _frames++;
+        _bytes += sizeof(hdr) + len;
+
+        int ret;
+        if (hdr.flags & SCAN_FRAME_COMPRESSED) {
+            /* qUncompress() allocates the length given by the prefix,
+             * it must not be trusted beyond the checked raw_len
+             */
+            if (len < 4 ||
+                qFromBigEndian<quint32>((const uchar *) _payload.constData()) != raw_len)
+                return -1;
+
+            QByteArray raw = qUncompress((const uchar *) _payload.constData(), len);
+            if ((quint32) raw.size() != raw_len)
+                return -1;
+            ret = decode_frame((const quint8 *) raw.constData(), raw.size());
+        } else {
+            ret = decode_frame((const quint8 *) _payload.constData(), len);
+        }
+        if (ret < 0)
+            return -1;
+
+        qint64 now = _clock.elapsed();
+        if (now >= next_batch) {
+            deliver();
+            next_batch = now + SCAN_NET_BATCH_MS;
+        }
+        if (now >= next_report) {
+            emit statistics(_records, _lost, _records * 1000.0 / now,
+                            _bytes * 1000.0 / now);
+            next_report = now + SCAN_NET_REPORT_MS;
+        }
+    }
+
+    deliver();
+
+    qint64 elapsed = qMax(_clock.elapsed(), (qint64) 1);
+    emit statistics(_records, _lost, _records * 1000.0 / elapsed,
+                    _bytes * 1000.0 / elapsed);
+
+    if (_recorder)
+        _recorder->flush();
+
+    return 0;
+}
+
+void ScanNetSource::run()
+{
+    QTcpSocket tcp;
+    QLocalSocket local;
+    QIODevice *dev;
+
+    if (_address.startsWith("unix:")) {
+        local.connectToServer(_address.mid(5));
+        if (!local.waitForConnected(SCAN_NET_CONNECT_MS)) {
+            _error = -1;
+            return;
+        }
+        dev = &local;
+    } else {
+        QString host = _address.section(':', 0, 0);
+        quint16 port = SCAN_AGENT_PORT;
+        if (_address.contains(':'))
+            port = _address.section(':', 1, 1).toUShort();
+
+        tcp.connectToHost(host, port);
+        if (!tcp.waitForConnected(SCAN_NET_CONNECT_MS)) {
+            _error = -1;
+            return;
+        }
+        dev = &tcp;
+    }
+
+    if (receive(dev) < 0)
+        _error = -1;
+}
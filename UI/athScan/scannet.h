@@ -0,0 +1,88 @@
+#ifndef SCANNET_H
+#define SCANNET_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QPolygonF>
+
+#include "athscan.h"
+#include "panorama.h"
+#include "mask.h"
+#include "perf.h"
+
+/* interval between two deliveries of received samples */
+#define SCAN_NET_BATCH_MS       20
+/* interval between two statistics reports */
+#define SCAN_NET_REPORT_MS      1000
+/* timeout of the connection to the agent */
+#define SCAN_NET_CONNECT_MS     5000
+
+class QIODevice;
+class TriggerRecorder;
+class SampleStore;
+
+/* ScanNetSource receives the samples streamed by athAgent.
+ *
+ * address is either host[:port] for TCP or unix:path for a Unix socket.
+ * Frames are read whole in a reused buffer and their records are decoded
+ * and appended to the store set with set_store(). The bin powers, the
+ * cells of the panorama and the mask violations are delivered in batches,
+ * like for ScanLoader. Gaps in the frame sequence numbers are accounted
+ * as lost frames.
+ */
+class ScanNetSource : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit ScanNetSource(QString address, QObject *parent = 0);
+    ~ScanNetSource();
+
+    void set_recorder(TriggerRecorder *);
+    void set_store(SampleStore *);
+    void set_mask(const SpectralMask &);
+
+    void cancel();
+    bool cancelled() const;
+    int error() const;
+
+    quint32 min_freq() const;
+    quint32 max_freq() const;
+
+signals:
+    void samples_ready(QPolygonF samples);
+    void panorama_ready(SpectrumPanorama panorama);
+    void mask_ready(MaskViolations violations);
+    void statistics(qint64 records, qint64 lost_frames,
+                    double record_rate, double byte_rate);
+
+protected:
+    virtual void run();
+
+private:
+    int read_full(QIODevice *, char *, qint64);
+    int receive(QIODevice *);
+    int decode_frame(const quint8 *, qint64);
+    void deliver();
+
+    QString _address;
+    TriggerRecorder *_recorder;
+
+    QAtomicInt _cancel;
+    int _error;
+
+    QByteArray _payload;
+    QPolygonF _batch;
+    SpectrumPanorama _panorama;
+    MaskViolations _mask;
+    PerfProbe _probe;
+
+    SampleStore *_store;
+    quint32 _min_freq, _max_freq;
+
+    QElapsedTimer _clock;
+    qint64 _records, _frames, _lost, _bytes;
+};
+
+#endif // SCANNET_H
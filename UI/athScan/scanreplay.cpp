@@ -0,0 +1,262 @@
+#include "scanreplay.h"
+#include "decoder.h"
+#include "recorder.h"
+#include "samplestore.h"
+
+#include <QFile>
+
+#include <qwt_trace.h>
+
+ScanReplay::ScanReplay(QString file_name, QObject *parent) :
+    QThread(parent),
+    _file_name(file_name),
+    _speed(1.0),
+    _firehose(false),
+    _recorder(NULL),
+    _store(NULL),
+    _cancel(0),
+    _error(0),
+    _pending(0),
+    _latency_us(0),
+    _batch_records(0),
+    _replayed(0),
+    _dropped(0)
+{
+}
+
+ScanReplay::~ScanReplay()
+{
+    cancel();
+    wait();
+}
+
+/* the settings have to be changed before the replay is started */
+void ScanReplay::set_speed(double speed)
+{
+    _speed = qBound(SCAN_REPLAY_MIN_SPEED, speed, SCAN_REPLAY_MAX_SPEED);
+}
+
+double ScanReplay::speed() const
+{
+    return _speed;
+}
+
+void ScanReplay::set_firehose(bool on)
+{
+    _firehose = on;
+}
+
+bool ScanReplay::firehose() const
+{
+    return _firehose;
+}
+
+void ScanReplay::set_recorder(TriggerRecorder *recorder)
+{
+    _recorder = recorder;
+}
+
+void ScanReplay::set_store(SampleStore *store)
+{
+    _store = store;
+}
+
+/* the samples are checked against mask, to be set before the start */
+void ScanReplay::set_mask(const SpectralMask &mask)
+{
+    _mask.set_mask(mask);
+}
+
+void ScanReplay::cancel()
+{
+    _cancel.store(1);
+}
+
+bool ScanReplay::cancelled() const
+{
+    return _cancel.load() != 0;
+}
+
+int ScanReplay::error() const
+{
+    return _error;
+}
+
+/* to be called by the consumer with the stamp of every batch it has
+ * processed, from any thread
+ */
+void ScanReplay::consumed(qint64 stamp)
+{
+    qint32 latency = (qint32) ((_clock.nsecsElapsed() - stamp) / 1000);
+    qint32 average = _latency_us.load();
+
+    /* exponential moving average */
+    _latency_us.store(average + (latency - average) / 8);
+    _pending.fetchAndAddOrdered(-1);
+}
+
+void ScanReplay::deliver()
+{
+    if (_batch.isEmpty())
+        return;
+
+    _probe.publish();
+
+    /* the violations are accounted even if the batch is dropped */
+    if (_mask.is_active()) {
+        emit mask_ready(_mask);
+        _mask.clear();
+    }
+
+    if (_pending.load() >= SCAN_REPLAY_MAX_PENDING) {
+        _dropped += _batch.size();
+        perf_stats()->dropped.fetchAndAddRelaxed(_batch_records);
+    } else {
+        _pending.fetchAndAddOrdered(1);
+        perf_stats()->queued.ref();
+        emit samples_ready(_batch, _clock.nsecsElapsed());
+        emit panorama_ready(_panorama);
+    }
+
+    _batch.clear();
+    _batch_records = 0;
+    _panorama.clear();
+}
+
+/* rates are given in bins per second */
+void ScanReplay::report(quint64 stream_us)
+{
+    double elapsed = _clock.nsecsElapsed() / 1e9;
+    double stream = stream_us / 1e6;
+
+    double target_rate = (_firehose || stream <= 0.0)
+                         ? 0.0 : _replayed / stream * _speed;
+    double achieved_rate = (elapsed > 0.0) ? _replayed / elapsed : 0.0;
+
+    emit statistics(target_rate, achieved_rate, _dropped,
+                    _latency_us.load() / 1000.0);
+}
+
+int ScanReplay::replay(const quint8 *buffer, qint64 size)
+{
+    quint8 sample[SCAN_MAX_SAMPLE_LEN];
+    quint64 stream_us = 0, last_tsf = 0;
+    qint64 next_batch = SCAN_REPLAY_BATCH_MS * 1000000LL;
+    qint64 next_report = SCAN_REPLAY_REPORT_MS * 1000000LL;
+    bool first = true;
+    qint64 i = 0;
+
+    _clock.start();
+    while (i < size) {
+        if (cancelled())
+            return -1;
+
+        qint32 len = tlv_sample_len(buffer + i, size - i);
+        if (len < 0)
+            return -1;
+
+        const tlv_decoder *decoder = tlv_decoder_lookup(buffer[i]);
+        _probe.start();
+        quint16 freq;
+        {
+            QWT_TRACE_SCOPE("TLV parse", "athscan");
+            freq = decoder->decode(buffer + i, len, sample);
+        }
+        _probe.decoded();
+        fft_sample_tlv *tlv = (fft_sample_tlv *) sample;
+
+        /* position of the record in the capture timeline, TSF resets
+         * are skipped
+         */
+        quint64 tsf = decoder->tsf(tlv);
+        if (!first && tsf > last_tsf)
+            stream_us += tsf - last_tsf;
+        last_tsf = tsf;
+        first = false;
+
+        if (!_firehose) {
+            qint64 deadline_ns = (qint64) (stream_us * 1000 / _speed);
+            qint64 wait_ns = deadline_ns - _clock.nsecsElapsed();
+            if (wait_ns > 0) {
+                /* do not hold back the samples while sleeping. A large
+                 * TSF gap is slept in slices, so that cancel() is not
+                 * held back either
+                 */
+                deliver();
+                while (wait_ns > 0) {
+                    if (cancelled())
+                        return -1;
+                    QThread::usleep(qMin(wait_ns / 1000,
+                                         (qint64) SCAN_REPLAY_SLEEP_MS * 1000));
+                    wait_ns = deadline_ns - _clock.nsecsElapsed();
+                }
+                _probe.resume();
+            }
+        }
+
+        qint32 first_bin = _batch.size();
+        {
+            QWT_TRACE_SCOPE("power compute", "athscan");
+            decoder->bin_pwr(tlv, _batch);
+        }
+        _probe.computed();
+        _batch_records++;
+        if (_store)
+            _store->append(tlv, len, freq);
+        if (_mask.is_active())
+            _mask.check(_batch.constData() + first_bin, _batch.size() - first_bin, tsf);
+        _panorama.add_sample(tlv);
+        if (_recorder)
+            _recorder->push(buffer + i, len, tlv,
+                            _batch.constData() + first_bin, _batch.size() - first_bin);
+
+        _replayed += _batch.size() - first_bin;
+        i += len;
+
+        qint64 now = _clock.nsecsElapsed();
+        if (now >= next_batch) {
+            deliver();
+            next_batch = now + SCAN_REPLAY_BATCH_MS * 1000000LL;
+        }
+        if (now >= next_report) {
+            report(stream_us);
+            next_report = now + SCAN_REPLAY_REPORT_MS * 1000000LL;
+        }
+    }
+
+    deliver();
+    report(stream_us);
+
+    if (_recorder)
+        _recorder->flush();
+
+    return 0;
+}
+
+void ScanReplay::run()
+{
+    QFile scan_file(_file_name);
+
+    if (!scan_file.open(QIODevice::ReadOnly)) {
+        _error = -1;
+        return;
+    }
+
+    QByteArray buffer;
+    qint64 size = scan_file.size();
+    const quint8 *data;
+    {
+        QWT_TRACE_SCOPE("file read", "athscan");
+        data = scan_file.map(0, size);
+        if (!data) {
+            buffer = scan_file.readAll();
+            data = (const quint8 *) buffer.constData();
+            size = buffer.size();
+        }
+    }
+
+    if (replay(data, size) < 0)
+        _error = -1;
+
+    scan_file.close();
+}
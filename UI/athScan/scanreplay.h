@@ -0,0 +1,99 @@
+#ifndef SCANREPLAY_H
+#define SCANREPLAY_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QPolygonF>
+
+#include "panorama.h"
+#include "mask.h"
+#include "perf.h"
+
+/* range of the speed factor */
+#define SCAN_REPLAY_MIN_SPEED       0.1
+#define SCAN_REPLAY_MAX_SPEED       1000.0
+/* interval between two deliveries of replayed samples */
+#define SCAN_REPLAY_BATCH_MS        20
+/* batches delivered but not yet consumed before samples are dropped */
+#define SCAN_REPLAY_MAX_PENDING     4
+/* interval between two statistics reports */
+#define SCAN_REPLAY_REPORT_MS       1000
+/* longest sleep of the pacing between two checks for cancel */
+#define SCAN_REPLAY_SLEEP_MS        10
+
+class TriggerRecorder;
+class SampleStore;
+
+/* ScanReplay re-emits the records of a capture as a live source.
+ *
+ * Records are paced on their TSF deltas, scaled by a speed factor, or
+ * sent as fast as possible in firehose mode. Samples are delivered in
+ * batches every SCAN_REPLAY_BATCH_MS: when the consumer is late and
+ * SCAN_REPLAY_MAX_PENDING batches are still in flight, the new batch is
+ * dropped. The consumer acknowledges every batch with consumed(), which
+ * gives the delivery latency. The achieved and target rates, the dropped
+ * bins and the average latency are reported by statistics(). Dropped
+ * batches are only skipped by the consumer, every record is appended to
+ * the store set with set_store() and checked against the mask set with
+ * set_mask().
+ */
+class ScanReplay : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit ScanReplay(QString file_name, QObject *parent = 0);
+    ~ScanReplay();
+
+    void set_speed(double);
+    double speed() const;
+    void set_firehose(bool);
+    bool firehose() const;
+    void set_recorder(TriggerRecorder *);
+    void set_store(SampleStore *);
+    void set_mask(const SpectralMask &);
+
+    void cancel();
+    bool cancelled() const;
+    int error() const;
+
+    void consumed(qint64 stamp);
+
+signals:
+    void samples_ready(QPolygonF samples, qint64 stamp);
+    void panorama_ready(SpectrumPanorama panorama);
+    void mask_ready(MaskViolations violations);
+    void statistics(double target_rate, double achieved_rate,
+                    qint64 dropped, double latency_ms);
+
+protected:
+    virtual void run();
+
+private:
+    int replay(const quint8 *, qint64);
+    void deliver();
+    void report(quint64 stream_us);
+
+    QString _file_name;
+    double _speed;
+    bool _firehose;
+    TriggerRecorder *_recorder;
+    SampleStore *_store;
+
+    QAtomicInt _cancel;
+    int _error;
+
+    QElapsedTimer _clock;
+    QAtomicInt _pending;
+    QAtomicInt _latency_us;
+
+    QPolygonF _batch;
+    qint32 _batch_records;
+    SpectrumPanorama _panorama;
+    MaskViolations _mask;
+    PerfProbe _probe;
+    qint64 _replayed, _dropped;
+};
+
+#endif // SCANREPLAY_H
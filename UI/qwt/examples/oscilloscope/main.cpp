@@ -14,6 +14,7 @@ int main( int argc, char **argv )
     samplingThread.setFrequency( window.frequency() );
     samplingThread.setAmplitude( window.amplitude() );
     samplingThread.setInterval( window.signalInterval() );
+    window.setSamplingThread( &samplingThread );
 
     window.connect( &window, SIGNAL( frequencyChanged( double ) ),
         &samplingThread, SLOT( setFrequency( double ) ) );
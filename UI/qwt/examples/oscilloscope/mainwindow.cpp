@@ -53,6 +53,11 @@ void MainWindow::start()
     d_plot->start();
 }
 
+void MainWindow::setSamplingThread( QwtSamplingThread *thread )
+{
+    d_plot->setSamplingThread( thread );
+}
+
 double MainWindow::frequency() const
 {
     return d_frequencyKnob->value();
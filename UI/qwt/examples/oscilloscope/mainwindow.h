@@ -3,6 +3,7 @@
 class Plot;
 class Knob;
 class WheelBox;
+class QwtSamplingThread;
 
 class MainWindow : public QWidget
 {
@@ -12,6 +13,7 @@ public:
     MainWindow( QWidget * = NULL );
 
     void start();
+    void setSamplingThread( QwtSamplingThread * );
 
     double amplitude() const;
     double frequency() const;
@@ -9,6 +9,7 @@
 #include <qwt_plot_directpainter.h>
 #include <qwt_curve_fitter.h>
 #include <qwt_painter.h>
+#include <qwt_sampling_thread.h>
 #include <qevent.h>
 
 class Canvas: public QwtPlotCanvas
@@ -78,6 +79,7 @@ private:
 Plot::Plot( QWidget *parent ):
     QwtPlot( parent ),
     d_paintedPoints( 0 ),
+    d_samplingThread( NULL ),
     d_interval( 0.0, 10.0 ),
     d_timerId( -1 )
 {
@@ -129,12 +131,14 @@ void Plot::start()
 void Plot::replot()
 {
     CurveData *data = static_cast<CurveData *>( d_curve->data() );
-    data->values().lock();
 
     QwtPlot::replot();
     d_paintedPoints = data->size();
+}
 
-    data->values().unlock();
+void Plot::setSamplingThread( QwtSamplingThread *thread )
+{
+    d_samplingThread = thread;
 }
 
 void Plot::setIntervalLength( double interval )
@@ -152,7 +156,16 @@ void Plot::setIntervalLength( double interval )
 void Plot::updateCurve()
 {
     CurveData *data = static_cast<CurveData *>( d_curve->data() );
-    data->values().lock();
+
+    if ( d_samplingThread )
+    {
+        // the sampling thread is never blocked by painting
+        QVector<QPointF> samples;
+        d_samplingThread->takeSamples( samples );
+
+        for ( int i = 0; i < samples.size(); i++ )
+            data->values().append( samples[i] );
+    }
 
     const int numPoints = data->size();
     if ( numPoints > d_paintedPoints )
@@ -181,8 +194,6 @@ void Plot::updateCurve()
             d_paintedPoints - 1, numPoints - 1 );
         d_paintedPoints = numPoints;
     }
-
-    data->values().unlock();
 }
 
 void Plot::incrementInterval()
@@ -5,6 +5,7 @@
 class QwtPlotCurve;
 class QwtPlotMarker;
 class QwtPlotDirectPainter;
+class QwtSamplingThread;
 
 class Plot: public QwtPlot
 {
@@ -17,6 +18,8 @@ public:
     void start();
     virtual void replot();
 
+    void setSamplingThread( QwtSamplingThread * );
+
     virtual bool eventFilter( QObject *, QEvent * );
 
 public Q_SLOTS:
@@ -36,6 +39,7 @@ private:
     int d_paintedPoints;
 
     QwtPlotDirectPainter *d_directPainter;
+    QwtSamplingThread *d_samplingThread;
 
     QwtInterval d_interval;
     int d_timerId;
@@ -1,5 +1,4 @@
 #include "samplingthread.h"
-#include "signaldata.h"
 #include <qwt_math.h>
 #include <math.h>
 
@@ -39,7 +38,7 @@ void SamplingThread::sample( double elapsed )
     if ( d_frequency > 0.0 )
     {
         const QPointF s( elapsed, value( elapsed ) );
-        SignalData::instance().append( s );
+        appendSample( s );
     }
 }
 
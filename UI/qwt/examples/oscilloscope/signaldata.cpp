@@ -1,7 +1,5 @@
 #include "signaldata.h"
 #include <qvector.h>
-#include <qmutex.h>
-#include <qreadwritelock.h>
 
 class SignalData::PrivateData
 {
@@ -34,13 +32,8 @@ public:
         }
     }
 
-    QReadWriteLock lock;
-
     QVector<QPointF> values;
     QRectF boundingRect;
-
-    QMutex mutex; // protecting pendingValues
-    QVector<QPointF> pendingValues;
 };
 
 SignalData::SignalData()
@@ -68,42 +61,13 @@ QRectF SignalData::boundingRect() const
     return d_data->boundingRect;
 }
 
-void SignalData::lock()
-{
-    d_data->lock.lockForRead();
-}
-
-void SignalData::unlock()
-{
-    d_data->lock.unlock();
-}
-
 void SignalData::append( const QPointF &sample )
 {
-    d_data->mutex.lock();
-    d_data->pendingValues += sample;
-
-    const bool isLocked = d_data->lock.tryLockForWrite();
-    if ( isLocked )
-    {
-        const int numValues = d_data->pendingValues.size();
-        const QPointF *pendingValues = d_data->pendingValues.data();
-
-        for ( int i = 0; i < numValues; i++ )
-            d_data->append( pendingValues[i] );
-
-        d_data->pendingValues.clear();
-
-        d_data->lock.unlock();
-    }
-
-    d_data->mutex.unlock();
+    d_data->append( sample );
 }
 
 void SignalData::clearStaleValues( double limit )
 {
-    d_data->lock.lockForWrite();
-
     d_data->boundingRect = QRectF( 1.0, 1.0, -2.0, -2.0 ); // invalid
 
     const QVector<QPointF> values = d_data->values;
@@ -122,8 +86,6 @@ void SignalData::clearStaleValues( double limit )
 
     while ( index < values.size() - 1 )
         d_data->append( values[index++] );
-
-    d_data->lock.unlock();
 }
 
 SignalData &SignalData::instance()
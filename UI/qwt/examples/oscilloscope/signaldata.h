@@ -16,9 +16,6 @@ public:
 
     QRectF boundingRect() const;
 
-    void lock();
-    void unlock();
-
 private:
     SignalData();
     SignalData( const SignalData & );
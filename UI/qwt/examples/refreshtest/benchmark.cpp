@@ -0,0 +1,248 @@
+#include <qimage.h>
+#include <qpainter.h>
+#include <qtextstream.h>
+#include <qvector.h>
+#include <qalgorithms.h>
+#include <qmath.h>
+#include <qwt_plot_curve.h>
+#include <qwt_plot_renderer.h>
+#include <qwt_painter.h>
+#include <qwt_system_clock.h>
+#include "benchmark.h"
+#include "plot.h"
+
+// time, the curve moves between 2 frames
+static const double frameStep = 0.02; // seconds
+
+static double percentile( const QVector<double> &sorted, double p )
+{
+    const int index = qCeil( p * sorted.size() ) - 1;
+    return sorted[ qBound( 0, index, sorted.size() - 1 ) ];
+}
+
+Benchmark::Benchmark():
+    d_frames( 50 ),
+    d_size( 800, 600 ),
+    d_format( Csv )
+{
+    d_pointCounts << 1000 << 10000 << 100000 << 1000000 << 10000000;
+}
+
+bool Benchmark::parseArguments( const QStringList &args )
+{
+    for ( int i = 1; i < args.size(); i++ )
+    {
+        const QString &arg = args[i];
+
+        if ( arg == "--benchmark" )
+            continue;
+
+        if ( i == args.size() - 1 )
+            return false;
+
+        const QString value = args[++i];
+        bool ok = true;
+
+        if ( arg == "--frames" )
+        {
+            d_frames = value.toInt( &ok );
+            ok = ok && d_frames > 0;
+        }
+        else if ( arg == "--size" )
+        {
+            const QStringList wh = value.split( 'x' );
+            ok = wh.size() == 2;
+            if ( ok )
+            {
+                bool okW, okH;
+                d_size = QSize( wh[0].toInt( &okW ), wh[1].toInt( &okH ) );
+                ok = okW && okH && d_size.isValid();
+            }
+        }
+        else if ( arg == "--points" )
+        {
+            d_pointCounts.clear();
+
+            const QStringList counts = value.split( ',' );
+            for ( int j = 0; ok && j < counts.size(); j++ )
+            {
+                const uint count = counts[j].toUInt( &ok );
+                ok = ok && count >= 2;
+
+                d_pointCounts += count;
+            }
+        }
+        else if ( arg == "--format" )
+        {
+            if ( value == "csv" )
+                d_format = Csv;
+            else if ( value == "json" )
+                d_format = Json;
+            else
+                ok = false;
+        }
+        else
+        {
+            ok = false;
+        }
+
+        if ( !ok )
+            return false;
+    }
+
+    return true;
+}
+
+QString Benchmark::usage()
+{
+    return "usage: refreshtest --benchmark [--frames n] [--size wxh]\n"
+        "                   [--points n1,n2,...] [--format csv|json]\n"
+        "Without a display ( Qt >= 5 ) add: -platform offscreen\n";
+}
+
+QList<Settings> Benchmark::sweep() const
+{
+    const int paintAttributes[] =
+    {
+        0,
+        QwtPlotCurve::ClipPolygons,
+        QwtPlotCurve::FilterPoints,
+        QwtPlotCurve::ClipPolygons | QwtPlotCurve::FilterPoints
+    };
+
+    QList<Settings> settingsList;
+
+    for ( int i = 0; i < d_pointCounts.size(); i++ )
+    {
+        for ( int j = 0; j < 4; j++ )
+        {
+            for ( int antialiased = 0; antialiased < 2; antialiased++ )
+            {
+                for ( int splitting = 0; splitting < 2; splitting++ )
+                {
+                    Settings s;
+                    s.curve.pen = QPen( Qt::black );
+                    s.curve.numPoints = d_pointCounts[i];
+                    s.curve.paintAttributes = paintAttributes[j];
+                    s.curve.renderHint = antialiased 
+                        ? QwtPlotItem::RenderAntialiased : 0;
+                    s.curve.lineSplitting = splitting;
+
+                    settingsList += s;
+                }
+            }
+        }
+    }
+
+    return settingsList;
+}
+
+Benchmark::Result Benchmark::run( Plot *plot, const Settings &settings ) const
+{
+    plot->setSettings( settings );
+
+    QImage image( d_size, QImage::Format_ARGB32_Premultiplied );
+
+    QwtPlotRenderer renderer;
+    QwtSystemClock clock;
+
+    QVector<double> times( d_frames );
+
+    for ( int i = 0; i < d_frames; i++ )
+    {
+        plot->setReferenceTime( i * frameStep );
+
+        image.fill( Qt::white );
+
+        clock.start();
+
+        QPainter painter( &image );
+        renderer.render( plot, &painter, QRectF( QPointF( 0, 0 ), d_size ) );
+        painter.end();
+
+        times[i] = clock.elapsed();
+    }
+
+    double sum = 0.0;
+    for ( int i = 0; i < times.size(); i++ )
+        sum += times[i];
+
+    qSort( times );
+
+    Result result;
+    result.mean = sum / times.size();
+    result.p50 = percentile( times, 0.5 );
+    result.p99 = percentile( times, 0.99 );
+    result.pointsPerSecond = ( result.mean > 0.0 )
+        ? settings.curve.numPoints / result.mean * 1000.0 : 0.0;
+
+    return result;
+}
+
+void Benchmark::writeHeader( QTextStream &out ) const
+{
+    if ( d_format == Csv )
+    {
+        out << "points,clipPolygons,filterPoints,antialiased,"
+            "lineSplitting,frames,mean_ms,p50_ms,p99_ms,points_per_s\n";
+    }
+}
+
+void Benchmark::writeResult( QTextStream &out, 
+    const Settings &s, const Result &result ) const
+{
+    const int attributes = s.curve.paintAttributes;
+
+    const int clip = ( attributes & QwtPlotCurve::ClipPolygons ) ? 1 : 0;
+    const int filter = ( attributes & QwtPlotCurve::FilterPoints ) ? 1 : 0;
+    const int antialiased = 
+        ( s.curve.renderHint & QwtPlotItem::RenderAntialiased ) ? 1 : 0;
+    const int splitting = s.curve.lineSplitting ? 1 : 0;
+
+    if ( d_format == Csv )
+    {
+        out << s.curve.numPoints << ',' << clip << ',' << filter << ','
+            << antialiased << ',' << splitting << ',' << d_frames << ','
+            << result.mean << ',' << result.p50 << ',' << result.p99 << ','
+            << qRound64( result.pointsPerSecond ) << '\n';
+    }
+    else
+    {
+        out << "{\"points\":" << s.curve.numPoints
+            << ",\"clipPolygons\":" << clip
+            << ",\"filterPoints\":" << filter
+            << ",\"antialiased\":" << antialiased
+            << ",\"lineSplitting\":" << splitting
+            << ",\"frames\":" << d_frames
+            << ",\"mean_ms\":" << result.mean
+            << ",\"p50_ms\":" << result.p50
+            << ",\"p99_ms\":" << result.p99
+            << ",\"points_per_s\":" << qRound64( result.pointsPerSecond )
+            << "}\n";
+    }
+}
+
+int Benchmark::exec()
+{
+    QTextStream out( stdout );
+
+    // the plot is never shown: all frames are rendered into a QImage
+    Plot plot;
+    plot.resize( d_size );
+
+    writeHeader( out );
+
+    const QList<Settings> settingsList = sweep();
+    for ( int i = 0; i < settingsList.size(); i++ )
+    {
+        const Result result = run( &plot, settingsList[i] );
+
+        writeResult( out, settingsList[i], result );
+        out.flush();
+    }
+
+    // restore the global default
+    QwtPainter::setPolylineSplitting( true );
+
+    return 0;
+}
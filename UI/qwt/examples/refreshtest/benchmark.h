@@ -0,0 +1,56 @@
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+#include <qlist.h>
+#include <qsize.h>
+#include <qstringlist.h>
+#include "settings.h"
+
+class Plot;
+class QTextStream;
+
+/*
+  Headless benchmark: the settings of the panel are swept over
+  a list of point counts and each combination is rendered offscreen
+  for a fixed number of frames. The frame times are written to stdout
+  as CSV or as one JSON object per line.
+ */
+class Benchmark
+{
+public:
+    enum Format
+    {
+        Csv,
+        Json
+    };
+
+    Benchmark();
+
+    bool parseArguments( const QStringList & );
+    static QString usage();
+
+    int exec();
+
+private:
+    class Result
+    {
+    public:
+        double mean;
+        double p50;
+        double p99;
+        double pointsPerSecond;
+    };
+
+    QList<Settings> sweep() const;
+    Result run( Plot *, const Settings & ) const;
+
+    void writeHeader( QTextStream & ) const;
+    void writeResult( QTextStream &, const Settings &, const Result & ) const;
+
+    int d_frames;
+    QSize d_size;
+    QList<uint> d_pointCounts;
+    Format d_format;
+};
+
+#endif
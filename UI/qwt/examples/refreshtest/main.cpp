@@ -1,5 +1,7 @@
 #include "mainwindow.h"
+#include "benchmark.h"
 #include <qapplication.h>
+#include <qtextstream.h>
 
 #ifndef QWT_NO_OPENGL
 #if QT_VERSION >= 0x040600 && QT_VERSION < 0x050000
@@ -22,6 +24,19 @@ int main( int argc, char **argv )
 
     QApplication a( argc, argv );
 
+    const QStringList args = a.arguments();
+    if ( args.contains( "--benchmark" ) )
+    {
+        Benchmark benchmark;
+        if ( !benchmark.parseArguments( args ) )
+        {
+            QTextStream( stderr ) << Benchmark::usage();
+            return 1;
+        }
+
+        return benchmark.exec();
+    }
+
     MainWindow mainWindow;
     mainWindow.resize( 600, 400 );
     mainWindow.show();
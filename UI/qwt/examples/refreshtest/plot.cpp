@@ -199,10 +199,15 @@ void Plot::setSettings( const Settings &s )
     d_settings = s;
 }
 
-void Plot::timerEvent( QTimerEvent * )
+void Plot::setReferenceTime( double seconds )
 {
     CircularBuffer *buffer = static_cast<CircularBuffer *>( d_curve->data() );
-    buffer->setReferenceTime( d_clock.elapsed() / 1000.0 );
+    buffer->setReferenceTime( seconds );
+}
+
+void Plot::timerEvent( QTimerEvent * )
+{
+    setReferenceTime( d_clock.elapsed() / 1000.0 );
 
     if ( d_settings.updateType == Settings::RepaintCanvas )
     {
@@ -15,6 +15,8 @@ class Plot: public QwtPlot
 public:
     Plot( QWidget* = NULL );
 
+    void setReferenceTime( double seconds );
+
 public Q_SLOTS:
     void setSettings( const Settings & );
 
@@ -16,12 +16,14 @@ HEADERS = \
     circularbuffer.h \
     panel.h \
     plot.h \
+    benchmark.h \
     mainwindow.h
 
 SOURCES = \
     circularbuffer.cpp \
     panel.cpp \
     plot.cpp \
+    benchmark.cpp \
     mainwindow.cpp \
     main.cpp
 
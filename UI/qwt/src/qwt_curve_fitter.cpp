@@ -451,3 +451,258 @@ QPolygonF QwtWeedingCurveFitter::simplify( const QPolygonF &points ) const
 
     return stripped;
 }
+
+class QwtDownsamplingCurveFitter::PrivateData
+{
+public:
+    PrivateData():
+        fitMode( QwtDownsamplingCurveFitter::M4 ),
+        columnWidth( 1.0 ),
+        threshold( 0 )
+    {
+    }
+
+    QwtDownsamplingCurveFitter::FitMode fitMode;
+    double columnWidth;
+    int threshold;
+};
+
+/*!
+   Constructor
+
+   \param mode Reduction algorithm
+   \sa setFitMode()
+*/
+QwtDownsamplingCurveFitter::QwtDownsamplingCurveFitter( FitMode mode )
+{
+    d_data = new PrivateData;
+    d_data->fitMode = mode;
+}
+
+//! Destructor
+QwtDownsamplingCurveFitter::~QwtDownsamplingCurveFitter()
+{
+    delete d_data;
+}
+
+/*!
+  Select the reduction algorithm
+
+  \param mode Reduction algorithm
+  \sa fitMode()
+*/
+void QwtDownsamplingCurveFitter::setFitMode( FitMode mode )
+{
+    d_data->fitMode = mode;
+}
+
+/*!
+  \return Reduction algorithm
+  \sa setFitMode()
+*/
+QwtDownsamplingCurveFitter::FitMode QwtDownsamplingCurveFitter::fitMode() const
+{
+    return d_data->fitMode;
+}
+
+/*!
+  Set the width of the columns the points are aggregated into
+
+  The width is in paint device coordinates, the default
+  setting of 1.0 matches one pixel for screen devices.
+
+  \param width Column width
+  \sa columnWidth(), setThreshold()
+*/
+void QwtDownsamplingCurveFitter::setColumnWidth( double width )
+{
+    if ( width > 0.0 )
+        d_data->columnWidth = width;
+}
+
+/*!
+  \return Width of the columns the points are aggregated into
+  \sa setColumnWidth()
+*/
+double QwtDownsamplingCurveFitter::columnWidth() const
+{
+    return d_data->columnWidth;
+}
+
+/*!
+  Set the number of points for the QwtDownsamplingCurveFitter::LTTB mode
+
+  For a threshold <= 0 the number of points is two times the 
+  number of columns covered by the polyline.
+
+  \param numPoints Number of points of the reduced polyline
+  \sa threshold(), setColumnWidth()
+*/
+void QwtDownsamplingCurveFitter::setThreshold( int numPoints )
+{
+    d_data->threshold = qMax( numPoints, 0 );
+}
+
+/*!
+  \return Number of points for the QwtDownsamplingCurveFitter::LTTB mode
+  \sa setThreshold()
+*/
+int QwtDownsamplingCurveFitter::threshold() const
+{
+    return d_data->threshold;
+}
+
+/*!
+  \param points Series of data points
+  \return Curve points
+*/
+QPolygonF QwtDownsamplingCurveFitter::fitCurve( const QPolygonF &points ) const
+{
+    if ( points.size() <= 4 )
+        return points;
+
+    if ( d_data->fitMode == LTTB )
+        return fitLTTB( points );
+
+    return fitM4( points );
+}
+
+QPolygonF QwtDownsamplingCurveFitter::fitM4( const QPolygonF &points ) const
+{
+    const QPointF *p = points.constData();
+    const int nPoints = points.size();
+
+    // The points are unclipped paint device coordinates, that might
+    // be far beyond the range of an int, when zooming in deep.
+    // Columns are calculated in double for this reason.
+
+    const QRectF br = points.boundingRect();
+    const double maxPoints = 
+        4.0 * ( ::ceil( br.width() / d_data->columnWidth ) + 1.0 );
+
+    QPolygonF fittedPoints;
+    fittedPoints.reserve( ( maxPoints < nPoints ) ? int( maxPoints ) : nPoints );
+
+    int from = 0;
+    while ( from < nPoints )
+    {
+        const double column = ::floor( p[from].x() / d_data->columnWidth );
+
+        int iMin = from;
+        int iMax = from;
+
+        int to = from + 1;
+        for ( ; to < nPoints; to++ )
+        {
+            if ( ::floor( p[to].x() / d_data->columnWidth ) != column )
+                break;
+
+            if ( p[to].y() < p[iMin].y() )
+                iMin = to;
+            if ( p[to].y() > p[iMax].y() )
+                iMax = to;
+        }
+
+        const int last = to - 1;
+
+        // first, min, max, last - in the order of the series
+
+        int i1 = qMin( iMin, iMax );
+        int i2 = qMax( iMin, iMax );
+
+        fittedPoints += p[from];
+        if ( i1 != from )
+            fittedPoints += p[i1];
+        if ( i2 != i1 && i2 != from )
+            fittedPoints += p[i2];
+        if ( last != i2 && last != from )
+            fittedPoints += p[last];
+
+        from = to;
+    }
+
+    return fittedPoints;
+}
+
+QPolygonF QwtDownsamplingCurveFitter::fitLTTB( const QPolygonF &points ) const
+{
+    const QPointF *p = points.constData();
+    const int nPoints = points.size();
+
+    int threshold = d_data->threshold;
+    if ( threshold <= 0 )
+    {
+        // bounded in double, as the points might be far beyond 
+        // the range of an int, when zooming in deep
+
+        const QRectF br = points.boundingRect();
+        const double numPoints = 
+            2.0 * ( ::ceil( br.width() / d_data->columnWidth ) + 1.0 );
+
+        threshold = ( numPoints < nPoints ) ? int( numPoints ) : nPoints;
+    }
+
+    if ( threshold < 3 || threshold >= nPoints )
+        return points;
+
+    QPolygonF fittedPoints;
+    fittedPoints.reserve( threshold );
+
+    // the first and the last point are always part of the result,
+    // the others are split into threshold - 2 buckets
+
+    const double bucketSize = double( nPoints - 2 ) / ( threshold - 2 );
+
+    int a = 0;
+    fittedPoints += p[a];
+
+    for ( int i = 0; i < threshold - 2; i++ )
+    {
+        // average of the next bucket
+
+        int avgFrom = qFloor( ( i + 1 ) * bucketSize ) + 1;
+        int avgTo = qMin( qFloor( ( i + 2 ) * bucketSize ) + 1, nPoints );
+        if ( avgFrom >= avgTo )
+            avgFrom = avgTo - 1;
+
+        double avgX = 0.0;
+        double avgY = 0.0;
+        for ( int j = avgFrom; j < avgTo; j++ )
+        {
+            avgX += p[j].x();
+            avgY += p[j].y();
+        }
+        avgX /= avgTo - avgFrom;
+        avgY /= avgTo - avgFrom;
+
+        // point of the current bucket with the largest triangle
+
+        const int from = qFloor( i * bucketSize ) + 1;
+        const int to = qFloor( ( i + 1 ) * bucketSize ) + 1;
+
+        const double ax = p[a].x();
+        const double ay = p[a].y();
+
+        double maxArea = -1.0;
+        int next = from;
+
+        for ( int j = from; j < to; j++ )
+        {
+            const double area = qFabs( ( ax - avgX ) * ( p[j].y() - ay )
+                - ( ax - p[j].x() ) * ( avgY - ay ) );
+
+            if ( area > maxArea )
+            {
+                maxArea = area;
+                next = j;
+            }
+        }
+
+        fittedPoints += p[next];
+        a = next;
+    }
+
+    fittedPoints += p[nPoints - 1];
+
+    return fittedPoints;
+}
@@ -136,4 +136,72 @@ private:
     PrivateData *d_data;
 };
 
+/*!
+  \brief A curve fitter reducing a polyline to the resolution of the
+         paint device
+
+  QwtPlotCurve passes the points in paint device coordinates to the 
+  curve fitter, so the x coordinate of a point identifies the 
+  pixel column it will be painted to. 
+
+  In QwtDownsamplingCurveFitter::M4 mode the points are aggregated into 
+  columns of columnWidth() and each column is represented by its first,
+  minimum, maximum and last point. As the extremes of each column
+  are preserved the rasterized polyline looks the same as the 
+  unreduced one. 
+
+  In QwtDownsamplingCurveFitter::LTTB mode the "Largest Triangle Three 
+  Buckets" algorithm picks a fixed number of points, that preserve the
+  visual shape of the curve. The result is smoother than M4, but 
+  single spikes might get lost.
+
+  Both algorithms run in linear time and the size of the result
+  is limited by the width of the polyline and not by the number of
+  points, what makes them suitable for long series with millions of
+  points. In opposite to QwtWeedingCurveFitter the points are expected
+  to be ordered by their x coordinates. Otherwise the result is 
+  still a valid approximation, but the number of points won't be reduced 
+  significantly.
+
+  \sa QwtPlotCurve::setCurveFitter(), QwtPlotCurve::Fitted
+*/
+class QWT_EXPORT QwtDownsamplingCurveFitter: public QwtCurveFitter
+{
+public:
+    /*!
+      Reduction algorithm
+      The default setting is M4
+      \sa setFitMode(), fitMode()
+     */
+    enum FitMode
+    {
+        //! First/min/max/last point of each pixel column
+        M4,
+
+        //! Largest Triangle Three Buckets
+        LTTB
+    };
+
+    QwtDownsamplingCurveFitter( FitMode = M4 );
+    virtual ~QwtDownsamplingCurveFitter();
+
+    void setFitMode( FitMode );
+    FitMode fitMode() const;
+
+    void setColumnWidth( double );
+    double columnWidth() const;
+
+    void setThreshold( int );
+    int threshold() const;
+
+    virtual QPolygonF fitCurve( const QPolygonF & ) const;
+
+private:
+    QPolygonF fitM4( const QPolygonF & ) const;
+    QPolygonF fitLTTB( const QPolygonF & ) const;
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
 #endif
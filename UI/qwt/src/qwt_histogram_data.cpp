@@ -0,0 +1,398 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_histogram_data.h"
+#include "qwt_math.h"
+#include <qnumeric.h>
+
+// below this scale factor the stored counts are renormalized
+static const double qwtMinScale = 1e-100;
+
+/*!
+  Constructor
+
+  \param range Initial range of the bins
+  \param numBins Number of bins
+
+  \sa setRange(), setBinMode()
+*/
+QwtHistogramData::QwtHistogramData( const QwtInterval &range, int numBins ):
+    d_binMode( FixedBins ),
+    d_min( 0.0 ),
+    d_binWidth( 0.0 ),
+    d_scale( 1.0 ),
+    d_maxCount( 0.0 ),
+    d_ignored( 0.0 ),
+    d_halfLife( 0.0 ),
+    d_dirtyFrom( -1 ),
+    d_dirtyTo( -1 ),
+    d_replot( true )
+{
+    setRange( range, numBins );
+}
+
+//! Destructor
+QwtHistogramData::~QwtHistogramData()
+{
+}
+
+/*!
+  Set the bin mode
+
+  \param mode Bin mode
+  \sa binMode()
+*/
+void QwtHistogramData::setBinMode( BinMode mode )
+{
+    d_binMode = mode;
+}
+
+/*!
+  \return Bin mode
+  \sa setBinMode()
+*/
+QwtHistogramData::BinMode QwtHistogramData::binMode() const
+{
+    return d_binMode;
+}
+
+/*!
+  \brief Set the range and the number of bins
+
+  All counts are reset.
+
+  \param range Range of the bins
+  \param numBins Number of bins. An odd number is rounded up,
+                 so that pairs of bins can be merged in AdaptiveBins mode.
+
+  \sa range(), binCount(), reset()
+*/
+void QwtHistogramData::setRange( const QwtInterval &range, int numBins )
+{
+    numBins = qMax( numBins, 1 );
+    if ( numBins % 2 )
+        numBins++;
+
+    const QwtInterval r = range.normalized();
+
+    d_min = r.minValue();
+    d_binWidth = r.width() / numBins;
+    if ( d_binWidth <= 0.0 )
+        d_binWidth = 1.0;
+
+    d_bins.fill( 0.0, numBins );
+
+    reset();
+}
+
+//! \return Range of all bins
+QwtInterval QwtHistogramData::range() const
+{
+    return QwtInterval( d_min, d_min + d_bins.size() * d_binWidth );
+}
+
+//! \return Number of bins
+int QwtHistogramData::binCount() const
+{
+    return d_bins.size();
+}
+
+/*!
+  \brief Set the half life used by decay()
+
+  \param halfLife Time, after which a count is weighted down to 50%.
+                  The unit is the one of the elapsed time
+                  passed to decay(). A value <= 0.0 disables decay.
+
+  \sa halfLife(), decay()
+*/
+void QwtHistogramData::setHalfLife( double halfLife )
+{
+    d_halfLife = halfLife;
+}
+
+/*!
+  \return Half life used by decay()
+  \sa setHalfLife()
+*/
+double QwtHistogramData::halfLife() const
+{
+    return d_halfLife;
+}
+
+/*!
+  \brief Insert a value
+
+  \param value Value
+  \param weight Weight of the value
+
+  \sa decay(), count()
+*/
+void QwtHistogramData::insert( double value, double weight )
+{
+    // an infinite value would extend the bins to an infinite width
+    if ( qIsNaN( value ) || qIsInf( value ) )
+        return;
+
+    int bin = binIndex( value );
+    if ( bin < 0 )
+    {
+        if ( d_binMode == FixedBins )
+        {
+            d_ignored += weight;
+            return;
+        }
+
+        extend( value );
+        bin = binIndex( value );
+    }
+
+    double &count = d_bins[bin];
+    count += weight / d_scale;
+
+    if ( count > d_maxCount )
+        d_maxCount = count;
+
+    setDirty( bin );
+}
+
+/*!
+  \brief Insert an array of values with a weight of 1.0
+
+  \param values Array of values
+  \param count Number of values
+*/
+void QwtHistogramData::insert( const double *values, int count )
+{
+    for ( int i = 0; i < count; i++ )
+        insert( values[i] );
+}
+
+/*!
+  \brief Weight down all counts
+
+  All counts are multiplied by 0.5^(elapsed / halfLife()).
+  Instead of touching each bin a common scale factor is modified,
+  that is applied when reading the counts.
+
+  \param elapsed Time since the previous call of decay()
+  \sa setHalfLife()
+*/
+void QwtHistogramData::decay( double elapsed )
+{
+    if ( d_halfLife <= 0.0 || elapsed <= 0.0 )
+        return;
+
+    const double factor = qPow( 0.5, elapsed / d_halfLife );
+
+    d_scale *= factor;
+    d_ignored *= factor;
+
+    if ( d_scale < qwtMinScale )
+        normalize();
+
+    d_replot = true;
+}
+
+//! Reset all counts to 0
+void QwtHistogramData::reset()
+{
+    d_bins.fill( 0.0 );
+
+    d_scale = 1.0;
+    d_maxCount = 0.0;
+    d_ignored = 0.0;
+
+    d_dirtyFrom = d_dirtyTo = -1;
+    d_replot = true;
+}
+
+/*!
+  \return Count of a bin
+  \param bin Index of the bin
+*/
+double QwtHistogramData::count( int bin ) const
+{
+    if ( bin < 0 || bin >= d_bins.size() )
+        return 0.0;
+
+    return d_bins[bin] * d_scale;
+}
+
+/*!
+  \return Weighted number of values, that have been ignored because
+          they were out of range in FixedBins mode
+*/
+double QwtHistogramData::ignoredCount() const
+{
+    return d_ignored;
+}
+
+//! \return True, when bins have been modified since clearDirty()
+bool QwtHistogramData::isDirty() const
+{
+    return d_replot || d_dirtyFrom >= 0;
+}
+
+/*!
+  \brief Range of the modified bins
+
+  \param from Index of the first modified bin
+  \param to Index of the last modified bin
+
+  \return False, when no bin has been modified since clearDirty()
+  \sa needsReplot(), clearDirty()
+*/
+bool QwtHistogramData::dirtyRange( int &from, int &to ) const
+{
+    if ( d_replot )
+    {
+        from = 0;
+        to = d_bins.size() - 1;
+
+        return true;
+    }
+
+    from = d_dirtyFrom;
+    to = d_dirtyTo;
+
+    return d_dirtyFrom >= 0;
+}
+
+/*!
+  \return True, when the geometry of the bins has changed or the 
+          counts have been decayed since clearDirty(). In this case
+          columns might have been shrunk or moved and painting the 
+          dirty range on top of the previous content is not sufficient.
+*/
+bool QwtHistogramData::needsReplot() const
+{
+    return d_replot;
+}
+
+/*!
+  Reset the dirty state. Usually called after the histogram has
+  been painted.
+
+  \sa dirtyRange(), needsReplot()
+*/
+void QwtHistogramData::clearDirty()
+{
+    d_dirtyFrom = d_dirtyTo = -1;
+    d_replot = false;
+}
+
+//! \return Number of bins
+size_t QwtHistogramData::size() const
+{
+    return d_bins.size();
+}
+
+/*!
+  \return Interval sample of a bin
+  \param i Index of the bin
+*/
+QwtIntervalSample QwtHistogramData::sample( size_t i ) const
+{
+    const double x1 = d_min + i * d_binWidth;
+
+    return QwtIntervalSample( d_bins[i] * d_scale, x1, x1 + d_binWidth );
+}
+
+/*!
+  \return Bounding rectangle of all bins, where the height 
+          is given by the maximum count
+*/
+QRectF QwtHistogramData::boundingRect() const
+{
+    return QRectF( d_min, 0.0, 
+        d_bins.size() * d_binWidth, d_maxCount * d_scale );
+}
+
+int QwtHistogramData::binIndex( double value ) const
+{
+    const double pos = ( value - d_min ) / d_binWidth;
+    if ( pos < 0.0 || pos >= d_bins.size() )
+        return -1;
+
+    return qMin( int( pos ), d_bins.size() - 1 );
+}
+
+/*
+  Double the width of the bins until value fits in. When
+  the value is below the range the bins are merged into the
+  upper half, otherwise into the lower half.
+ */
+void QwtHistogramData::extend( double value )
+{
+    const int numBins = d_bins.size();
+    const int half = numBins / 2;
+
+    while ( binIndex( value ) < 0 )
+    {
+        const bool below = value < d_min;
+
+        for ( int i = 0; i < half; i++ )
+        {
+            if ( below )
+            {
+                const int j = numBins - 1 - i;
+                d_bins[j] = d_bins[2 * j - numBins] 
+                    + d_bins[2 * j - numBins + 1];
+            }
+            else
+            {
+                d_bins[i] = d_bins[2 * i] + d_bins[2 * i + 1];
+            }
+        }
+
+        if ( below )
+        {
+            for ( int i = 0; i < half; i++ )
+                d_bins[i] = 0.0;
+
+            d_min -= numBins * d_binWidth;
+        }
+        else
+        {
+            for ( int i = half; i < numBins; i++ )
+                d_bins[i] = 0.0;
+        }
+
+        d_binWidth *= 2.0;
+    }
+
+    d_maxCount = 0.0;
+    for ( int i = 0; i < numBins; i++ )
+        d_maxCount = qMax( d_maxCount, d_bins[i] );
+
+    d_replot = true;
+}
+
+void QwtHistogramData::normalize()
+{
+    for ( int i = 0; i < d_bins.size(); i++ )
+        d_bins[i] *= d_scale;
+
+    d_maxCount *= d_scale;
+    d_scale = 1.0;
+}
+
+void QwtHistogramData::setDirty( int bin )
+{
+    if ( d_dirtyFrom < 0 )
+    {
+        d_dirtyFrom = d_dirtyTo = bin;
+    }
+    else
+    {
+        d_dirtyFrom = qMin( d_dirtyFrom, bin );
+        d_dirtyTo = qMax( d_dirtyTo, bin );
+    }
+}
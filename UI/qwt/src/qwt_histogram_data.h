@@ -0,0 +1,115 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_HISTOGRAM_DATA_H
+#define QWT_HISTOGRAM_DATA_H 1
+
+#include "qwt_global.h"
+#include "qwt_series_data.h"
+#include <qvector.h>
+
+/*!
+  \brief Incremental histogram for QwtPlotHistogram
+
+  QwtHistogramData counts values into equidistant bins, that are
+  offered as a series of interval samples. Inserting a value is O(1),
+  so it can be fed from a live stream without rebuilding
+  the intervals for every frame.
+
+  The bins that have been modified since the last call of clearDirty()
+  are tracked. As long as values have only been inserted the counts of
+  these bins can only grow and it is sufficient to paint the dirty 
+  range with QwtPlotDirectPainter::drawSeries(). When the geometry of 
+  the bins has changed or the counts have been decayed needsReplot() 
+  indicates, that the complete histogram has to be replotted.
+  QwtPlotHistogram::updateDirtyColumns() implements this decision.
+
+  For live views counts can be weighted down with decay(). The
+  decay is applied as a global scale factor, so it is O(1) too.
+
+  \sa QwtPlotHistogram::setSamples()
+*/
+class QWT_EXPORT QwtHistogramData: public QwtSeriesData<QwtIntervalSample>
+{
+public:
+    /*!
+      \brief Bin modes
+      \sa setBinMode()
+     */
+    enum BinMode
+    {
+        //! Values outside of range() are ignored
+        FixedBins,
+
+        /*!
+          The range is extended by doubling the width of the bins,
+          until values outside of range() fit in. The number of bins
+          doesn't change.
+         */
+        AdaptiveBins
+    };
+
+    explicit QwtHistogramData( const QwtInterval &range = 
+        QwtInterval( 0.0, 1.0 ), int numBins = 100 );
+
+    virtual ~QwtHistogramData();
+
+    void setBinMode( BinMode );
+    BinMode binMode() const;
+
+    void setRange( const QwtInterval &, int numBins );
+    QwtInterval range() const;
+    int binCount() const;
+
+    void setHalfLife( double );
+    double halfLife() const;
+
+    void insert( double value, double weight = 1.0 );
+    void insert( const double *values, int count );
+
+    void decay( double elapsed );
+    void reset();
+
+    double count( int bin ) const;
+    double ignoredCount() const;
+
+    bool isDirty() const;
+    bool dirtyRange( int &from, int &to ) const;
+    bool needsReplot() const;
+    void clearDirty();
+
+    virtual size_t size() const;
+    virtual QwtIntervalSample sample( size_t i ) const;
+    virtual QRectF boundingRect() const;
+
+private:
+    int binIndex( double value ) const;
+    void extend( double value );
+    void normalize();
+    void setDirty( int bin );
+
+    BinMode d_binMode;
+
+    double d_min;
+    double d_binWidth;
+    QVector<double> d_bins;
+
+    // counts are stored divided by d_scale
+    double d_scale;
+    double d_maxCount;
+    double d_ignored;
+
+    double d_halfLife;
+
+    int d_dirtyFrom;
+    int d_dirtyTo;
+    bool d_replot;
+};
+
+#endif
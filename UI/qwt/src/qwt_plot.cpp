@@ -16,12 +16,15 @@
 #include "qwt_legend.h"
 #include "qwt_legend_data.h"
 #include "qwt_plot_canvas.h"
+#include "qwt_system_clock.h"
+#include "qwt_trace.h"
 #include <qmath.h>
 #include <qpainter.h>
 #include <qpointer.h>
 #include <qpaintengine.h>
 #include <qapplication.h>
 #include <qevent.h>
+#include <qtimer.h>
 
 static inline void qwtEnableLegendItems( QwtPlot *plot, bool on )
 {
@@ -101,6 +104,14 @@ public:
     QwtPlotLayout *layout;
 
     bool autoReplot;
+
+    QTimer *replotTimer;
+    QwtSystemClock replotClock;
+    double replotDue;
+    int replotInterval;
+
+    int coalescedReplots;
+    int droppedReplots;
 };
 
 /*!
@@ -145,6 +156,16 @@ void QwtPlot::initPlot( const QwtText &title )
     d_data->layout = new QwtPlotLayout;
     d_data->autoReplot = false;
 
+    d_data->replotTimer = new QTimer( this );
+    d_data->replotTimer->setSingleShot( true );
+    connect( d_data->replotTimer, SIGNAL( timeout() ),
+        this, SLOT( scheduledReplot() ) );
+
+    d_data->replotDue = 0.0;
+    d_data->replotInterval = 0;
+    d_data->coalescedReplots = 0;
+    d_data->droppedReplots = 0;
+
     // title
     d_data->titleLabel = new QwtTextLabel( this );
     d_data->titleLabel->setObjectName( "QwtPlotTitle" );
@@ -324,6 +345,116 @@ bool QwtPlot::autoReplot() const
     return d_data->autoReplot;
 }
 
+/*!
+  \brief Set the minimum interval between two scheduled replots
+
+  scheduleReplot() delays a replot until the interval since the 
+  previous replot has passed. So the interval caps the frame rate
+  of the plot: f.e. 40 ms result in not more than 25 frames per second.
+
+  \param msecs Interval in milliseconds. With 0 the replot is
+               delayed until control returns to the event loop.
+
+  \sa replotInterval(), scheduleReplot()
+*/
+void QwtPlot::setReplotInterval( int msecs )
+{
+    d_data->replotInterval = qMax( msecs, 0 );
+}
+
+/*!
+  \return Minimum interval between two scheduled replots
+  \sa setReplotInterval()
+*/
+int QwtPlot::replotInterval() const
+{
+    return d_data->replotInterval;
+}
+
+/*!
+  \return Number of replot requests, that have been merged into
+          a pending replot since resetReplotStatistics()
+  \sa scheduleReplot(), droppedReplots()
+*/
+int QwtPlot::coalescedReplots() const
+{
+    return d_data->coalescedReplots;
+}
+
+/*!
+  \return Number of frames, that have been missed since
+          resetReplotStatistics(), because a scheduled replot was
+          executed more than replotInterval() after its due time.
+          
+  A growing number indicates, that the event loop is too busy
+  to achieve the frame rate.
+
+  \sa scheduleReplot(), coalescedReplots()
+*/
+int QwtPlot::droppedReplots() const
+{
+    return d_data->droppedReplots;
+}
+
+/*!
+  Reset the counters of coalesced and dropped replots
+
+  \sa coalescedReplots(), droppedReplots()
+*/
+void QwtPlot::resetReplotStatistics()
+{
+    d_data->coalescedReplots = 0;
+    d_data->droppedReplots = 0;
+}
+
+/*!
+  \brief Request a replot
+
+  In opposite to replot() the plot is not redrawn immediately.
+  All requests, that arrive until the replot is executed, are
+  coalesced into a single replot, that happens when control returns
+  to the event loop, but not before replotInterval() has passed
+  since the previous replot.
+
+  Calling scheduleReplot() from handlers of bursty events
+  avoids redundant repaints without any throttling in the application.
+
+  \sa replot(), setReplotInterval(), coalescedReplots()
+*/
+void QwtPlot::scheduleReplot()
+{
+    if ( d_data->replotTimer->isActive() )
+    {
+        d_data->coalescedReplots++;
+        return;
+    }
+
+    double delay = 0.0;
+    if ( !d_data->replotClock.isNull() )
+    {
+        delay = d_data->replotInterval - d_data->replotClock.elapsed();
+        delay = qMax( delay, 0.0 );
+
+        d_data->replotDue = d_data->replotClock.elapsed() + delay;
+    }
+
+    d_data->replotTimer->start( qCeil( delay ) );
+}
+
+void QwtPlot::scheduledReplot()
+{
+    if ( d_data->replotInterval > 0 && !d_data->replotClock.isNull() )
+    {
+        const double late = 
+            d_data->replotClock.elapsed() - d_data->replotDue;
+
+        if ( late > d_data->replotInterval )
+            d_data->droppedReplots += int( late / d_data->replotInterval );
+    }
+
+    replot();
+}
+
 /*!
   Change the plot's title
   \param title New title
@@ -540,10 +671,21 @@ void QwtPlot::resizeEvent( QResizeEvent *e )
   or if any curves are attached to raw data, the plot has to
   be refreshed explicitly in order to make changes visible.
 
-  \sa updateAxes(), setAutoReplot()
+  \sa updateAxes(), setAutoReplot(), scheduleReplot()
 */
 void QwtPlot::replot()
 {
+    QWT_TRACE_SCOPE( "QwtPlot::replot", "qwt" );
+
+    if ( d_data->replotTimer->isActive() )
+    {
+        // the pending request is served by this replot
+        d_data->replotTimer->stop();
+        d_data->coalescedReplots++;
+    }
+
+    d_data->replotClock.start();
+
     bool doAutoReplot = autoReplot();
     setAutoReplot( false );
 
@@ -773,6 +915,9 @@ void QwtPlot::drawItems( QPainter *painter, const QRectF &canvasRect,
             painter->setRenderHint( QPainter::HighQualityAntialiasing,
                 item->testRenderHint( QwtPlotItem::RenderAntialiased ) );
 
+            QWT_TRACE_SCOPE_ARG( "QwtPlotItem::draw", "qwt",
+                "rtti", item->rtti() );
+
             item->draw( painter,
                 maps[item->xAxis()], maps[item->yAxis()],
                 canvasRect );
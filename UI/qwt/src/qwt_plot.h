@@ -139,6 +139,13 @@ public:
     void setAutoReplot( bool = true );
     bool autoReplot() const;
 
+    void setReplotInterval( int msecs );
+    int replotInterval() const;
+
+    int coalescedReplots() const;
+    int droppedReplots() const;
+    void resetReplotStatistics();
+
     // Layout
 
     void setPlotLayout( QwtPlotLayout * );
@@ -281,6 +288,7 @@ Q_SIGNALS:
 
 public Q_SLOTS:
     virtual void replot();
+    void scheduleReplot();
     void autoRefresh();
 
 protected:
@@ -289,6 +297,7 @@ protected:
     virtual void resizeEvent( QResizeEvent *e );
 
 private Q_SLOTS:
+    void scheduledReplot();
     void updateLegendItems( const QVariant &itemInfo,
         const QList<QwtLegendData> &data );
 
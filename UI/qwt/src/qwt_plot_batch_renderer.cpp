@@ -0,0 +1,452 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_plot_batch_renderer.h"
+#include "qwt_scale_engine.h"
+#include "qwt_scale_draw.h"
+#include "qwt_scale_map.h"
+#include "qwt_series_data.h"
+#include <qpainter.h>
+#include <qpalette.h>
+#include <qfontmetrics.h>
+#include <qfileinfo.h>
+#include <qatomic.h>
+#ifndef QWT_NO_SVG
+#ifdef QT_SVG_LIB
+#include <qsvggenerator.h>
+#endif
+#endif
+#if QT_VERSION >= 0x040400
+#include <qthread.h>
+#include <qfuture.h>
+#include <qtconcurrentrun.h>
+#endif
+
+class QwtPlotBatchRenderer::PrivateData
+{
+public:
+    PrivateData():
+        numThreads( 0 )
+    {
+    }
+
+    QFont font;
+    uint numThreads;
+};
+
+static QwtScaleDiv qwtScaleDiv( const QwtInterval &interval,
+    double min, double max )
+{
+    const QwtLinearScaleEngine engine;
+
+    if ( interval.isValid() )
+    {
+        return engine.divideScale( interval.minValue(),
+            interval.maxValue(), 8, 5 );
+    }
+
+    double x1 = min;
+    double x2 = max;
+    double stepSize = 0.0;
+
+    engine.autoScale( 8, x1, x2, stepSize );
+    return engine.divideScale( x1, x2, 8, 5, stepSize );
+}
+
+/*
+  Paint a job without any widget: only painters, scale draws
+  and plot items are used, what is safe in a worker thread
+ */
+static bool qwtRenderPlot( QPainter *painter, const QRectF &rect,
+    const QFont &font, const QwtPlotBatchRenderer::Job &job )
+{
+    const double margin = 5.0;
+    const double spacing = 2.0;
+
+    painter->fillRect( rect, job.background );
+    painter->setFont( font );
+
+    const QFontMetricsF fm( font );
+
+    QRectF br( 0.0, 0.0, 1.0, 1.0 );
+    if ( !job.samples.isEmpty() )
+        br = qwtBoundingRect( QwtPointSeriesData( job.samples ) );
+
+    QwtScaleDraw xScaleDraw;
+    xScaleDraw.setAlignment( QwtScaleDraw::BottomScale );
+    xScaleDraw.setScaleDiv( qwtScaleDiv( job.xInterval, br.left(), br.right() ) );
+
+    QwtScaleDraw yScaleDraw;
+    yScaleDraw.setAlignment( QwtScaleDraw::LeftScale );
+    yScaleDraw.setScaleDiv( qwtScaleDiv( job.yInterval, br.top(), br.bottom() ) );
+
+    // the border distances depend on the lengths of the scales
+    xScaleDraw.setLength( rect.width() );
+    yScaleDraw.setLength( rect.height() );
+
+    // start is left/top, end is right/bottom
+    int xStartDist, xEndDist, yStartDist, yEndDist;
+    xScaleDraw.getBorderDistHint( font, xStartDist, xEndDist );
+    yScaleDraw.getBorderDistHint( font, yStartDist, yEndDist );
+
+    const double titleHeight = job.title.isEmpty() ? 0.0 : fm.height() + spacing;
+    const double xTitleHeight = job.xTitle.isEmpty() ? 0.0 : fm.height() + spacing;
+    const double yTitleWidth = job.yTitle.isEmpty() ? 0.0 : fm.height() + spacing;
+
+    const double left = margin + yTitleWidth 
+        + qMax( yScaleDraw.extent( font ), double( xStartDist ) );
+    const double right = margin + xEndDist;
+    const double top = margin + titleHeight + yStartDist;
+    const double bottom = margin + xTitleHeight 
+        + qMax( xScaleDraw.extent( font ), double( yEndDist ) );
+
+    const QRectF canvasRect = rect.adjusted( left, top, -right, -bottom );
+    if ( !canvasRect.isValid() )
+        return false;
+
+    QwtScaleMap xMap;
+    xMap.setPaintInterval( canvasRect.left(), canvasRect.right() );
+    xMap.setScaleInterval( xScaleDraw.scaleDiv().lowerBound(),
+        xScaleDraw.scaleDiv().upperBound() );
+
+    QwtScaleMap yMap;
+    yMap.setPaintInterval( canvasRect.bottom(), canvasRect.top() );
+    yMap.setScaleInterval( yScaleDraw.scaleDiv().lowerBound(),
+        yScaleDraw.scaleDiv().upperBound() );
+
+    painter->fillRect( canvasRect, job.canvasBackground );
+
+    QwtPlotCurve curve;
+    curve.setPen( job.pen );
+    curve.setStyle( job.style );
+    curve.setSamples( job.samples );
+
+    painter->save();
+    painter->setClipRect( canvasRect );
+    curve.draw( painter, xMap, yMap, canvasRect );
+    painter->restore();
+
+    // the default palette would be the one of the application
+    QPalette palette( job.background );
+    palette.setColor( QPalette::WindowText, Qt::black );
+    palette.setColor( QPalette::Text, Qt::black );
+
+    xScaleDraw.move( canvasRect.bottomLeft() );
+    xScaleDraw.setLength( canvasRect.width() );
+    xScaleDraw.draw( painter, palette );
+
+    yScaleDraw.move( canvasRect.topLeft() );
+    yScaleDraw.setLength( canvasRect.height() );
+    yScaleDraw.draw( painter, palette );
+
+    painter->setPen( Qt::black );
+
+    if ( !job.title.isEmpty() )
+    {
+        painter->drawText( QRectF( rect.left(), rect.top() + margin,
+            rect.width(), fm.height() ), Qt::AlignCenter, job.title );
+    }
+
+    if ( !job.xTitle.isEmpty() )
+    {
+        painter->drawText( QRectF( canvasRect.left(),
+            rect.bottom() - margin - fm.height(),
+            canvasRect.width(), fm.height() ), Qt::AlignCenter, job.xTitle );
+    }
+
+    if ( !job.yTitle.isEmpty() )
+    {
+        painter->save();
+        painter->translate( rect.left() + margin, canvasRect.bottom() );
+        painter->rotate( -90.0 );
+        painter->drawText( QRectF( 0.0, 0.0, canvasRect.height(), fm.height() ),
+            Qt::AlignCenter, job.yTitle );
+        painter->restore();
+    }
+
+    return true;
+}
+
+static QString qwtJobFormat( const QwtPlotBatchRenderer::Job &job )
+{
+    QString format = job.format;
+    if ( format.isEmpty() )
+        format = QFileInfo( job.fileName ).suffix();
+
+    return format.toLower();
+}
+
+static bool qwtHasSvg()
+{
+#ifndef QWT_NO_SVG
+#ifdef QT_SVG_LIB
+#if QT_VERSION >= 0x040500
+    return true;
+#endif
+#endif
+#endif
+    return false;
+}
+
+// jobs, that can't be rendered, are rejected before the workers start
+static bool qwtCheckJob( QwtPlotBatchRenderer::Job &job )
+{
+    if ( job.size.isEmpty() )
+    {
+        job.errorString = "empty size";
+        return false;
+    }
+
+    if ( qwtJobFormat( job ) == "svg" )
+    {
+        if ( !qwtHasSvg() )
+        {
+            job.errorString = "SVG is not supported";
+            return false;
+        }
+
+        if ( job.fileName.isEmpty() )
+        {
+            job.errorString = "SVG needs a file name";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool qwtRenderJob( const QFont &font, QImage &image,
+    QwtPlotBatchRenderer::Job &job )
+{
+    const QString format = qwtJobFormat( job );
+    const QRectF rect( 0.0, 0.0, job.size.width(), job.size.height() );
+
+    if ( format == "svg" )
+    {
+#ifndef QWT_NO_SVG
+#ifdef QT_SVG_LIB
+#if QT_VERSION >= 0x040500
+        QSvgGenerator generator;
+        generator.setFileName( job.fileName );
+        generator.setSize( job.size );
+        generator.setViewBox( rect );
+
+        QPainter painter( &generator );
+        if ( !qwtRenderPlot( &painter, rect, font, job ) )
+        {
+            job.errorString = "rendering failed";
+            return false;
+        }
+
+        return true;
+#endif
+#endif
+#endif
+    }
+
+    // The result of a job without file name is painted into the
+    // image of the job, so that the images returned by a previous 
+    // render() are recycled. The image of the worker is reused 
+    // for all jobs writing files.
+
+    QImage &target = job.fileName.isEmpty() ? job.image : image;
+    if ( target.size() != job.size || target.format() != QImage::Format_ARGB32 )
+        target = QImage( job.size, QImage::Format_ARGB32 );
+
+    QPainter painter( &target );
+    const bool ok = qwtRenderPlot( &painter, rect, font, job );
+    painter.end();
+
+    if ( !ok )
+    {
+        job.errorString = "rendering failed";
+        return false;
+    }
+
+    if ( job.fileName.isEmpty() )
+        return true;
+
+    if ( !target.save( job.fileName, format.toLatin1() ) )
+    {
+        job.errorString = "writing the image failed";
+        return false;
+    }
+
+    return true;
+}
+
+static void qwtRenderJobs( const QFont &font,
+    QwtPlotBatchRenderer::Job *jobs, int numJobs, QAtomicInt *nextJob )
+{
+    // paint device, that is reused for all jobs of this worker
+    QImage image;
+
+    while ( true )
+    {
+        const int index = nextJob->fetchAndAddOrdered( 1 );
+        if ( index >= numJobs )
+            break;
+
+        if ( jobs[index].errorString.isEmpty() )
+            jobs[index].ok = qwtRenderJob( font, image, jobs[index] );
+    }
+}
+
+//! Default constructor
+QwtPlotBatchRenderer::Job::Job():
+    pen( Qt::black ),
+    style( QwtPlotCurve::Lines ),
+    background( Qt::white ),
+    canvasBackground( Qt::white ),
+    ok( false )
+{
+}
+
+/*!
+  Constructor
+
+  \param samples Points of the curve
+  \param size Size in pixels
+  \param fileName File name. When empty the result is stored in image
+  \param format Format. When empty it is derived from the file suffix
+*/
+QwtPlotBatchRenderer::Job::Job( const QVector<QPointF> &samples, 
+        const QSize &size, const QString &fileName, const QString &format ):
+    samples( samples ),
+    pen( Qt::black ),
+    style( QwtPlotCurve::Lines ),
+    background( Qt::white ),
+    canvasBackground( Qt::white ),
+    size( size ),
+    fileName( fileName ),
+    format( format ),
+    ok( false )
+{
+}
+
+//! Constructor
+QwtPlotBatchRenderer::QwtPlotBatchRenderer()
+{
+    d_data = new PrivateData;
+}
+
+//! Destructor
+QwtPlotBatchRenderer::~QwtPlotBatchRenderer()
+{
+    delete d_data;
+}
+
+/*!
+  Set the font of the titles and scale labels
+
+  \param font Font
+  \sa font()
+*/
+void QwtPlotBatchRenderer::setFont( const QFont &font )
+{
+    d_data->font = font;
+}
+
+/*!
+  \return Font of the titles and scale labels
+  \sa setFont()
+*/
+QFont QwtPlotBatchRenderer::font() const
+{
+    return d_data->font;
+}
+
+/*!
+  Set the number of worker threads
+
+  \param numThreads Number of threads. If numThreads is set to 0, 
+                    the system specific ideal thread count is used.
+
+  The default thread count is 0.
+
+  \sa threadCount()
+*/
+void QwtPlotBatchRenderer::setThreadCount( uint numThreads )
+{
+    d_data->numThreads = numThreads;
+}
+
+/*!
+  \return Number of worker threads
+  \sa setThreadCount()
+*/
+uint QwtPlotBatchRenderer::threadCount() const
+{
+    return d_data->numThreads;
+}
+
+/*!
+  Render all jobs
+
+  The calling thread works on the jobs too and returns,
+  when all jobs have been rendered.
+
+  \param jobs Jobs to be rendered. The ok flags, error strings 
+              and images of the jobs are updated. Jobs, that
+              can't be rendered - f.e. SVG documents without 
+              file name - are rejected before rendering.
+
+  \return Number of jobs, that have been rendered successfully
+*/
+int QwtPlotBatchRenderer::render( QVector<Job> &jobs ) const
+{
+    for ( int i = 0; i < jobs.size(); i++ )
+    {
+        jobs[i].ok = false;
+        jobs[i].errorString.clear();
+
+        qwtCheckJob( jobs[i] );
+    }
+
+    // detach, before the workers access the jobs
+    Job *data = jobs.data();
+
+    QAtomicInt nextJob( 0 );
+
+    uint numThreads = d_data->numThreads;
+
+#if QT_VERSION >= 0x040400 && !defined(QT_NO_QFUTURE)
+    if ( numThreads == 0 )
+        numThreads = QThread::idealThreadCount();
+
+    if ( numThreads <= 0 )
+        numThreads = 1;
+
+    numThreads = qMin( numThreads, uint( qMax( jobs.size(), 1 ) ) );
+
+    QList< QFuture<void> > futures;
+    for ( uint i = 1; i < numThreads; i++ )
+    {
+        futures += QtConcurrent::run( &qwtRenderJobs, 
+            d_data->font, data, jobs.size(), &nextJob );
+    }
+
+    qwtRenderJobs( d_data->font, data, jobs.size(), &nextJob );
+
+    for ( int i = 0; i < futures.size(); i++ )
+        futures[i].waitForFinished();
+#else
+    numThreads = 1;
+    qwtRenderJobs( d_data->font, data, jobs.size(), &nextJob );
+#endif
+
+    int numRendered = 0;
+    for ( int i = 0; i < jobs.size(); i++ )
+    {
+        if ( jobs[i].ok )
+            numRendered++;
+    }
+
+    return numRendered;
+}
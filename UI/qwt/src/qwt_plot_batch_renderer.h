@@ -0,0 +1,139 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_PLOT_BATCH_RENDERER_H
+#define QWT_PLOT_BATCH_RENDERER_H
+
+#include "qwt_global.h"
+#include "qwt_interval.h"
+#include "qwt_plot_curve.h"
+#include <qsize.h>
+#include <qstring.h>
+#include <qimage.h>
+#include <qvector.h>
+#include <qpen.h>
+#include <qcolor.h>
+#include <qfont.h>
+
+/*!
+  \brief Renderer for exporting many plots in parallel
+
+  QwtPlotBatchRenderer renders a list of jobs offscreen
+  into images, image files or SVG documents using several
+  worker threads. Each worker reuses its QImage as paint device
+  for all jobs of the same size, avoiding an allocation per job.
+
+  Images of jobs without file name are recycled: rendering the same
+  list of jobs again paints into the images of the previous run.
+
+  A job is not a QwtPlot, but the samples of a curve and the
+  configuration of the plot: title, axes, scales, pen and size.
+  The workers build the scale divisions and the curve on their own
+  and paint them without any widget, as QWidget must not be used
+  outside of the GUI thread. The layout is a simplified version
+  of the one of QwtPlot: a title, a left and a bottom axis and
+  the canvas.
+
+  \sa QwtPlotRenderer
+*/
+class QWT_EXPORT QwtPlotBatchRenderer
+{
+public:
+    //! A plot, that is rendered by render()
+    class QWT_EXPORT Job
+    {
+    public:
+        Job();
+        Job( const QVector<QPointF> &, const QSize &,
+            const QString &fileName = QString(),
+            const QString &format = QString() );
+
+        //! Points of the curve
+        QVector<QPointF> samples;
+
+        //! Title of the plot
+        QString title;
+
+        //! Title of the x axis
+        QString xTitle;
+
+        //! Title of the y axis
+        QString yTitle;
+
+        /*!
+          Scale interval of the x axis. When the interval is invalid
+          the x axis is autoscaled to the bounding rectangle of
+          the samples.
+         */
+        QwtInterval xInterval;
+
+        /*!
+          Scale interval of the y axis. When the interval is invalid
+          the y axis is autoscaled to the bounding rectangle of
+          the samples.
+         */
+        QwtInterval yInterval;
+
+        //! Pen of the curve
+        QPen pen;
+
+        //! Style of the curve
+        QwtPlotCurve::CurveStyle style;
+
+        //! Background of the plot
+        QColor background;
+
+        //! Background of the canvas
+        QColor canvasBackground;
+
+        //! Size of the image or SVG view box in pixels
+        QSize size;
+
+        /*!
+          File, where the document is written to. When the file name
+          is empty the result is stored in image.
+         */
+        QString fileName;
+
+        /*!
+          "svg" or an image format supported by QImageWriter. When
+          the format is empty, it is derived from the file suffix.
+         */
+        QString format;
+
+        /*!
+          Rendered image, when no file name is given. An image of
+          the size of the job is recycled by the next render().
+         */
+        QImage image;
+
+        //! true, when the job has been rendered successfully
+        bool ok;
+
+        //! Reason of the failure, when ok is false
+        QString errorString;
+    };
+
+    QwtPlotBatchRenderer();
+    virtual ~QwtPlotBatchRenderer();
+
+    void setFont( const QFont & );
+    QFont font() const;
+
+    void setThreadCount( uint numThreads );
+    uint threadCount() const;
+
+    int render( QVector<Job> & ) const;
+
+private:
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
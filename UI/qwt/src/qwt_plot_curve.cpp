@@ -45,6 +45,85 @@ static void qwtUpdateLegendIconSize( QwtPlotCurve *curve )
     }
 }
 
+// upper limit for the size of an image buffer in device resolution
+static const double qwtMaxImagePixels = 16.0 * 1024 * 1024;
+
+// device pixels per unit of the paint coordinates
+static void qwtDeviceScale( const QPainter *painter, double &sx, double &sy )
+{
+    const QTransform transform = painter->combinedTransform();
+
+    sx = qSqrt( transform.m11() * transform.m11() 
+        + transform.m12() * transform.m12() );
+    sy = qSqrt( transform.m21() * transform.m21() 
+        + transform.m22() * transform.m22() );
+
+    if ( sx <= 0.0 )
+        sx = 1.0;
+    if ( sy <= 0.0 )
+        sy = 1.0;
+}
+
+/*
+  Image buffers are rendered at the resolution of the paint device,
+  what differs from the one of the paint coordinates, when exporting
+  to a high resolution device. QwtDeviceImage offers the maps, the
+  bounding rectangle and the pen scaled to the device resolution.
+ */
+class QwtDeviceImage
+{
+public:
+    QwtDeviceImage( const QPainter *painter, const QRectF &canvasRect,
+            const QwtScaleMap &xMap, const QwtScaleMap &yMap ):
+        xMap( xMap ),
+        yMap( yMap )
+    {
+        qwtDeviceScale( painter, d_sx, d_sy );
+
+        // bound the memory of the image
+        const double numPixels = canvasRect.width() * d_sx 
+            * canvasRect.height() * d_sy;
+        if ( numPixels > qwtMaxImagePixels )
+        {
+            const double f = qSqrt( qwtMaxImagePixels / numPixels );
+            d_sx *= f;
+            d_sy *= f;
+        }
+
+        this->xMap.setPaintInterval( xMap.p1() * d_sx, xMap.p2() * d_sx );
+        this->yMap.setPaintInterval( yMap.p1() * d_sy, yMap.p2() * d_sy );
+
+        boundingRect = QRectF( canvasRect.x() * d_sx, canvasRect.y() * d_sy,
+            canvasRect.width() * d_sx, canvasRect.height() * d_sy );
+    }
+
+    QPen scaledPen( const QPen &pen ) const
+    {
+        QPen scaled = pen;
+        if ( !pen.isCosmetic() )
+            scaled.setWidthF( pen.widthF() * 0.5 * ( d_sx + d_sy ) );
+
+        return scaled;
+    }
+
+    // paint an image, that has been rendered for boundingRect
+    void draw( QPainter *painter, const QImage &image ) const
+    {
+        const QRect rect = boundingRect.toAlignedRect();
+
+        painter->drawImage( QRectF( rect.x() / d_sx, rect.y() / d_sy,
+            rect.width() / d_sx, rect.height() / d_sy ), image );
+    }
+
+    QwtScaleMap xMap;
+    QwtScaleMap yMap;
+    QRectF boundingRect;
+
+private:
+    double d_sx;
+    double d_sy;
+};
+
 static int qwtVerifyRange( int size, int &i1, int &i2 )
 {
     if ( size < 1 )
@@ -59,6 +138,35 @@ static int qwtVerifyRange( int size, int &i1, int &i2 )
     return ( i2 - i1 + 1 );
 }
 
+// index of the first sample in [from, to] with x >= value ( x > value
+// for upper ), or to + 1 if there is none
+
+static int qwtSearchX( const QwtSeriesData<QPointF> *series,
+    int from, int to, double value, bool upper )
+{
+    int indexMin = from;
+    int n = to - from + 1;
+
+    while ( n > 0 )
+    {
+        const int half = n >> 1;
+        const int indexMid = indexMin + half;
+
+        const double x = series->sample( indexMid ).x();
+        if ( upper ? ( x <= value ) : ( x < value ) )
+        {
+            indexMin = indexMid + 1;
+            n -= half + 1;
+        }
+        else
+        {
+            n = half;
+        }
+    }
+
+    return indexMin;
+}
+
 class QwtPlotCurve::PrivateData
 {
 public:
@@ -359,6 +467,9 @@ void QwtPlotCurve::drawSeries( QPainter *painter,
 
     if ( qwtVerifyRange( numSamples, from, to ) > 0 )
     {
+        if ( d_data->paintAttributes & SortedXValues )
+            visibleRange( xMap, canvasRect, from, to );
+
         painter->save();
         painter->setPen( d_data->pen );
 
@@ -382,6 +493,48 @@ void QwtPlotCurve::drawSeries( QPainter *painter,
     }
 }
 
+/*!
+  \brief Reduce an interval of samples to the visible part of the canvas
+
+  For samples with increasing x coordinates the first and last
+  index of the visible samples are found by a binary search. One
+  sample on each side of the visible interval is kept, so that
+  lines, steps and fillings leaving the canvas are still complete.
+
+  \param xMap Maps x-values into pixel coordinates.
+  \param canvasRect Contents rectangle of the canvas
+  \param from Index of the first point to be painted, might be increased
+  \param to Index of the last point to be painted, might be decreased
+
+  \sa SortedXValues, drawSeries()
+*/
+void QwtPlotCurve::visibleRange( const QwtScaleMap &xMap, 
+    const QRectF &canvasRect, int &from, int &to ) const
+{
+    // points outside of the canvas might still have
+    // parts of their symbol or pen inside
+
+    double margin = qMax( qreal( 1.0 ), d_data->pen.widthF() );
+    if ( d_data->symbol && 
+        ( d_data->symbol->style() != QwtSymbol::NoSymbol ) )
+    {
+        margin += d_data->symbol->boundingRect().width();
+    }
+
+    double x1 = xMap.invTransform( canvasRect.left() - margin );
+    double x2 = xMap.invTransform( canvasRect.right() + margin );
+    if ( x1 > x2 )
+        qSwap( x1, x2 );
+
+    const QwtSeriesData<QPointF> *series = data();
+
+    const int i1 = qwtSearchX( series, from, to, x1, false );
+    const int i2 = qwtSearchX( series, i1, to, x2, true );
+
+    from = qMin( qMax( from, i1 - 1 ), to );
+    to = qMax( qMin( to, i2 ), from );
+}
+
 /*!
   \brief Draw the line part (without symbols) of a curve interval.
   \param painter Painter
@@ -473,7 +626,7 @@ void QwtPlotCurve::drawLines( QPainter *painter,
         // because both operations are much more expensive
         // then drawing the polyline itself
 
-        if ( !doFit && !doFill )
+        if ( !doFit && !doFill && !( d_data->paintAttributes & ReducePoints ) )
             doIntegers = true; 
     }
 #endif
@@ -485,6 +638,21 @@ void QwtPlotCurve::drawLines( QPainter *painter,
     mapper.setFlag( QwtPointMapper::WeedOutPoints, noDuplicates );
     mapper.setBoundingRect( canvasRect );
 
+    if ( ( d_data->paintAttributes & ImageBuffer ) && !doFit && !doFill )
+    {
+        const QwtDeviceImage deviceImage( painter, canvasRect, xMap, yMap );
+        mapper.setBoundingRect( deviceImage.boundingRect );
+
+        const QImage image = mapper.toPolylineImage( 
+            deviceImage.xMap, deviceImage.yMap, data(), from, to, 
+            deviceImage.scaledPen( painter->pen() ), 
+            painter->testRenderHint( QPainter::Antialiasing ),
+            renderThreadCount() );
+
+        deviceImage.draw( painter, image );
+        return;
+    }
+
     if ( doIntegers )
     {
         const QPolygon polyline = mapper.toPolygon( 
@@ -508,7 +676,21 @@ void QwtPlotCurve::drawLines( QPainter *painter,
             data(), from, to );
 
         if ( doFit )
+        {
             polyline = d_data->curveFitter->fitCurve( polyline );
+        }
+        else if ( d_data->paintAttributes & ReducePoints )
+        {
+            // one column for each pixel of the device
+            double sx, sy;
+            qwtDeviceScale( painter, sx, sy );
+
+            QwtDownsamplingCurveFitter fitter( 
+                QwtDownsamplingCurveFitter::M4 );
+            fitter.setColumnWidth( 1.0 / sx );
+
+            polyline = fitter.fitCurve( polyline );
+        }
 
         if ( d_data->paintAttributes & ClipPolygons )
         {
@@ -543,13 +725,33 @@ void QwtPlotCurve::drawLines( QPainter *painter,
 */
 void QwtPlotCurve::drawSticks( QPainter *painter,
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
-    const QRectF &, int from, int to ) const
+    const QRectF &canvasRect, int from, int to ) const
 {
     painter->save();
     painter->setRenderHint( QPainter::Antialiasing, false );
 
     const bool doAlign = QwtPainter::roundingAlignment( painter );
 
+    if ( d_data->paintAttributes & ImageBuffer )
+    {
+        const QwtDeviceImage deviceImage( painter, canvasRect, xMap, yMap );
+
+        QwtPointMapper mapper;
+        mapper.setFlag( QwtPointMapper::RoundPoints, doAlign );
+        mapper.setBoundingRect( deviceImage.boundingRect );
+
+        const QImage image = mapper.toSticksImage( 
+            deviceImage.xMap, deviceImage.yMap, data(), from, to, 
+            orientation(), d_data->baseline, 
+            deviceImage.scaledPen( painter->pen() ), 
+            false, renderThreadCount() );
+
+        deviceImage.draw( painter, image );
+        painter->restore();
+
+        return;
+    }
+
     double x0 = xMap.transform( d_data->baseline );
     double y0 = yMap.transform( d_data->baseline );
     if ( doAlign )
@@ -634,12 +836,16 @@ void QwtPlotCurve::drawDots( QPainter *painter,
     }
     else if ( d_data->paintAttributes & ImageBuffer )
     {
-        const QImage image = mapper.toImage( xMap, yMap,
-            data(), from, to, d_data->pen, 
+        const QwtDeviceImage deviceImage( painter, canvasRect, xMap, yMap );
+        mapper.setBoundingRect( deviceImage.boundingRect );
+
+        const QImage image = mapper.toImage( 
+            deviceImage.xMap, deviceImage.yMap, data(), from, to, 
+            deviceImage.scaledPen( d_data->pen ), 
             painter->testRenderHint( QPainter::Antialiasing ),
             renderThreadCount() );
 
-        painter->drawImage( canvasRect.toAlignedRect(), image );
+        deviceImage.draw( painter, image );
     }
     else if ( d_data->paintAttributes & MinimizeMemory )
     {
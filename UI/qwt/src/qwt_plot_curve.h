@@ -203,8 +203,42 @@ public:
           having a huge amount of points. 
           With a reasonable number of points QPainter::drawPoints()
           will be faster.
+
+          For the Lines and Sticks styles the image is split into 
+          horizontal tiles, one for each of the 
+          QwtPlotItem::renderThreadCount() threads. With the default 
+          thread count of 1 the image is rasterized by the calling 
+          thread, what only pays off, when the paint device is 
+          slower than a QImage ( f.e. an exported vector document ).
+          Lines with a brush or Fitted lines are always painted 
+          without image buffer.
+         */
+        ImageBuffer = 0x08,
+
+        /*!
+          Promise, that the x coordinates of the samples are
+          in increasing order. The range of samples, that has to be
+          painted is found by a binary search for the visible
+          x interval, instead of mapping and clipping all points.
+          This is a substantial improvement, when zooming into a
+          small part of a long series.
+
+          \note The result is undefined, when the samples are not sorted
+                 or contain NaN values for x.
          */
-        ImageBuffer = 0x08
+        SortedXValues = 0x10,
+
+        /*!
+          Reduce the polyline of the Lines style to the first, minimum,
+          maximum and last point of each pixel column of the paint
+          device ( see QwtDownsamplingCurveFitter::M4 ). The result 
+          looks the same, but might have a tiny fraction of the points,
+          what matters when exporting huge series to vector formats.
+          Fitted curves are not reduced.
+
+          \sa QwtPlotRenderer::ReduceSeries
+         */
+        ReducePoints = 0x20
     };
 
     //! Paint attributes
@@ -301,6 +335,9 @@ protected:
     void closePolyline( QPainter *,
         const QwtScaleMap &, const QwtScaleMap &, QPolygonF & ) const;
 
+    void visibleRange( const QwtScaleMap &, const QRectF &canvasRect,
+        int &from, int &to ) const;
+
 private:
     class PrivateData;
     PrivateData *d_data;
@@ -9,6 +9,8 @@
 
 #include "qwt_plot_histogram.h"
 #include "qwt_plot.h"
+#include "qwt_plot_directpainter.h"
+#include "qwt_histogram_data.h"
 #include "qwt_painter.h"
 #include "qwt_column_symbol.h"
 #include "qwt_scale_map.h"
@@ -39,13 +41,15 @@ public:
     PrivateData():
         baseline( 0.0 ),
         style( Columns ),
-        symbol( NULL )
+        symbol( NULL ),
+        directPainter( NULL )
     {
     }
 
     ~PrivateData()
     {
         delete symbol;
+        delete directPainter;
     }
 
     double baseline;
@@ -54,6 +58,8 @@ public:
     QBrush brush;
     QwtPlotHistogram::HistogramStyle style;
     const QwtColumnSymbol *symbol;
+
+    QwtPlotDirectPainter *directPainter;
 };
 
 /*!
@@ -310,6 +316,8 @@ void QwtPlotHistogram::setSamples(
   \param data Data
   \warning The item takes ownership of the data object, deleting
            it when its not used anymore.
+
+  \sa QwtHistogramData
 */
 void QwtPlotHistogram::setSamples( 
     QwtSeriesData<QwtIntervalSample> *data )
@@ -317,6 +325,63 @@ void QwtPlotHistogram::setSamples(
     setData( data );
 }
 
+/*!
+  \brief Repaint the modified columns of a QwtHistogramData
+
+  When the samples are a QwtHistogramData only the columns, that have
+  been modified since the previous update, are painted on top of the
+  canvas using QwtPlotDirectPainter. Inserted values only let columns 
+  grow, so that the new columns cover the previous ones.
+
+  A replot is scheduled instead, when the bins have been moved or
+  decayed ( see QwtHistogramData::needsReplot() ), when the style is
+  not Columns, where growing shapes would leave the previous ones 
+  visible, or when the counts exceed an autoscaled axis.
+
+  \sa QwtHistogramData::dirtyRange(), QwtPlot::scheduleReplot()
+*/
+void QwtPlotHistogram::updateDirtyColumns()
+{
+    QwtHistogramData *histogram = 
+        dynamic_cast<QwtHistogramData *>( data() );
+
+    QwtPlot *plot = this->plot();
+    if ( histogram == NULL || plot == NULL )
+        return;
+
+    int from, to;
+    if ( !histogram->dirtyRange( from, to ) )
+        return;
+
+    bool replot = histogram->needsReplot() || d_data->style != Columns;
+    if ( !replot )
+    {
+        const bool horizontal = ( orientation() == Qt::Horizontal );
+
+        const int axisId = horizontal ? xAxis() : yAxis();
+        if ( plot->axisAutoScale( axisId ) )
+        {
+            const QRectF rect = boundingRect();
+            const double maxValue = horizontal ? rect.right() : rect.bottom();
+
+            replot = maxValue > plot->axisInterval( axisId ).maxValue();
+        }
+    }
+
+    histogram->clearDirty();
+
+    if ( replot )
+    {
+        plot->scheduleReplot();
+        return;
+    }
+
+    if ( d_data->directPainter == NULL )
+        d_data->directPainter = new QwtPlotDirectPainter();
+
+    d_data->directPainter->drawSeries( this, from, to );
+}
+
 /*!
   Draw a subset of the histogram samples
 
@@ -109,6 +109,8 @@ public:
 
     virtual QwtGraphic legendIcon( int index, const QSizeF & ) const;
 
+    void updateDirtyColumns();
+
 protected:
     virtual QwtColumnRect columnRect( const QwtIntervalSample &,
         const QwtScaleMap &, const QwtScaleMap & ) const;
@@ -15,6 +15,8 @@
 #include <qpainter.h>
 #include <qpaintengine.h>
 #include <qmath.h>
+#include <qcache.h>
+#include <qpair.h>
 #if QT_VERSION >= 0x040400
 #include <qthread.h>
 #include <qfuture.h>
@@ -30,6 +32,10 @@ public:
         paintAttributes( QwtPlotRasterItem::PaintInDeviceResolution )
     {
         cache.policy = QwtPlotRasterItem::NoCache;
+
+        tileCache.xFactor = tileCache.yFactor = 0.0;
+        tileCache.xTransformed = tileCache.yTransformed = false;
+        tileCache.tiles.setMaxCost( 32 * 1024 );
     }
 
     int alpha;
@@ -43,8 +49,58 @@ public:
         QSizeF size;
         QImage image;
     } cache;
+
+    struct TileCache
+    {
+        // resolution of the scale maps, the tiles have been rendered for
+        double xFactor;
+        double yFactor;
+        bool xTransformed;
+        bool yTransformed;
+
+        // tiles by position in the pixel grid, cost in kBytes
+        QCache< QPair<qint64, qint64>, QImage > tiles;
+    } tileCache;
 };
 
+static const int qwtTileSize = 256;
+
+static inline double qwtTransformValue( const QwtScaleMap &map, double value )
+{
+    const QwtTransform *transform = map.transformation();
+    return transform ? transform->transform( value ) : value;
+}
+
+static inline double qwtInvTransformValue( const QwtScaleMap &map, double value )
+{
+    const QwtTransform *transform = map.transformation();
+    return transform ? transform->invTransform( value ) : value;
+}
+
+// paint device units per transformed scale unit. As long as it doesn't 
+// change a position in scale coordinates is mapped to the same position
+// in a global pixel grid, that is only shifted, when panning.
+
+static inline double qwtResolution( const QwtScaleMap &map )
+{
+    const double ts1 = qwtTransformValue( map, map.s1() );
+    const double ts2 = qwtTransformValue( map, map.s2() );
+
+    if ( ts1 == ts2 )
+        return 1.0;
+
+    return ( map.p2() - map.p1() ) / ( ts2 - ts1 );
+}
+
+static inline qint64 qwtTileIndex( qint64 pos )
+{
+    // rounding towards negative infinity
+    if ( pos >= 0 )
+        return pos / qwtTileSize;
+
+    return -( ( -pos - 1 ) / qwtTileSize ) - 1;
+}
+
 
 static QRectF qwtAlignRect(const QRectF &rect)
 {
@@ -363,7 +419,8 @@ static bool qwtUseCache( QwtPlotRasterItem::CachePolicy policy,
 {
     bool doCache = false;
 
-    if ( policy == QwtPlotRasterItem::PaintCache )
+    if ( policy == QwtPlotRasterItem::PaintCache ||
+        policy == QwtPlotRasterItem::TileCache )
     {
         // Caching doesn't make sense, when the item is
         // not painted to screen
@@ -557,6 +614,29 @@ QwtPlotRasterItem::CachePolicy QwtPlotRasterItem::cachePolicy() const
     return d_data->cache.policy;
 }
 
+/*!
+  Set the memory limit of the tile cache
+
+  When the tiles exceed the limit the least recently used tiles
+  are removed from the cache. The default setting is 32MB.
+
+  \param kBytes Memory limit in kBytes
+  \sa tileCacheSize(), setCachePolicy(), TileCache
+*/
+void QwtPlotRasterItem::setTileCacheSize( int kBytes )
+{
+    d_data->tileCache.tiles.setMaxCost( qMax( kBytes, 0 ) );
+}
+
+/*!
+  \return Memory limit of the tile cache in kBytes
+  \sa setTileCacheSize()
+*/
+int QwtPlotRasterItem::tileCacheSize() const
+{
+    return d_data->tileCache.tiles.maxCost();
+}
+
 /*!
    Invalidate the paint cache
    \sa setCachePolicy()
@@ -566,6 +646,8 @@ void QwtPlotRasterItem::invalidateCache()
     d_data->cache.image = QImage();
     d_data->cache.area = QRect();
     d_data->cache.size = QSize();
+
+    d_data->tileCache.tiles.clear();
 }
 
 /*!
@@ -676,8 +758,15 @@ void QwtPlotRasterItem::draw( QPainter *painter,
         // When we have no information about position and size of
         // data pixels we render in resolution of the paint device.
 
-        image = compose(xxMap, yyMap, 
-            area, paintRect, paintRect.size().toSize(), doCache);
+        if ( doCache && d_data->cache.policy == TileCache )
+        {
+            image = composeTiles( xxMap, yyMap, paintRect );
+        }
+        else
+        {
+            image = compose(xxMap, yyMap, 
+                area, paintRect, paintRect.size().toSize(), doCache);
+        }
         if ( image.isNull() )
             return;
 
@@ -846,9 +935,144 @@ QImage QwtPlotRasterItem::compose(
         }
     }
 
+    return alphaImage( image );
+}
+
+/*!
+  \brief Compose an image from the tile cache
+
+  The paint rectangle is covered by tiles of a global pixel grid,
+  that is defined by the resolution of the maps. Tiles missing in
+  the cache are rendered by renderImage() and inserted into the cache.
+
+  \param xMap X-Scale Map
+  \param yMap Y-Scale Map
+  \param paintRect Rectangle of the image in paint device coordinates
+
+  \return Image for paintRect
+  \sa TileCache, setTileCacheSize()
+*/
+QImage QwtPlotRasterItem::composeTiles( 
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QRectF &paintRect ) const
+{
+    const QRect rect( QPoint( qRound( paintRect.left() ), 
+        qRound( paintRect.top() ) ), paintRect.size().toSize() );
+
+    if ( rect.isEmpty() )
+        return QImage();
+
+    PrivateData::TileCache &cache = d_data->tileCache;
+
+    const double fx = qwtResolution( xMap );
+    const double fy = qwtResolution( yMap );
+    const bool xTransformed = xMap.transformation() != NULL;
+    const bool yTransformed = yMap.transformation() != NULL;
+
+    if ( !qFuzzyCompare( fx, cache.xFactor ) 
+        || !qFuzzyCompare( fy, cache.yFactor )
+        || xTransformed != cache.xTransformed 
+        || yTransformed != cache.yTransformed )
+    {
+        // zooming: none of the tiles can be reused
+
+        cache.tiles.clear();
+
+        cache.xFactor = fx;
+        cache.yFactor = fy;
+        cache.xTransformed = xTransformed;
+        cache.yTransformed = yTransformed;
+    }
+
+    // offset between paint device and global pixel grid
+
+    const qint64 ox = qRound64( 
+        qwtTransformValue( xMap, xMap.s1() ) * fx - xMap.p1() );
+    const qint64 oy = qRound64( 
+        qwtTransformValue( yMap, yMap.s1() ) * fy - yMap.p1() );
+
+    const qint64 tx1 = qwtTileIndex( rect.left() + ox );
+    const qint64 tx2 = qwtTileIndex( rect.right() + ox );
+    const qint64 ty1 = qwtTileIndex( rect.top() + oy );
+    const qint64 ty2 = qwtTileIndex( rect.bottom() + oy );
+
+    const QSize tileSize( qwtTileSize, qwtTileSize );
+
+    QImage image( rect.size(), QImage::Format_ARGB32 );
+
+    QPainter painter( &image );
+    painter.setCompositionMode( QPainter::CompositionMode_Source );
+
+    for ( qint64 ty = ty1; ty <= ty2; ty++ )
+    {
+        for ( qint64 tx = tx1; tx <= tx2; tx++ )
+        {
+            const QPair<qint64, qint64> key( tx, ty );
+
+            QImage tile;
+
+            const QImage *cachedTile = cache.tiles.object( key );
+            if ( cachedTile )
+            {
+                tile = *cachedTile;
+            }
+            else
+            {
+                const double gx = tx * qwtTileSize;
+                const double gy = ty * qwtTileSize;
+
+                QwtScaleMap xxMap = xMap;
+                xxMap.setPaintInterval( 0.0, qwtTileSize );
+                xxMap.setScaleInterval( 
+                    qwtInvTransformValue( xMap, gx / fx ),
+                    qwtInvTransformValue( xMap, ( gx + qwtTileSize ) / fx ) );
+
+                QwtScaleMap yyMap = yMap;
+                yyMap.setPaintInterval( 0.0, qwtTileSize );
+                yyMap.setScaleInterval( 
+                    qwtInvTransformValue( yMap, gy / fy ),
+                    qwtInvTransformValue( yMap, ( gy + qwtTileSize ) / fy ) );
+
+                const QRectF area = QRectF( 
+                    QPointF( xxMap.s1(), yyMap.s1() ),
+                    QPointF( xxMap.s2(), yyMap.s2() ) ).normalized();
+
+                tile = renderImage( xxMap, yyMap, area, tileSize );
+                if ( tile.format() != QImage::Format_ARGB32 )
+                    tile = tile.convertToFormat( QImage::Format_ARGB32 );
+
+                // the cache might delete the tile immediately,
+                // when it exceeds the limit
+
+                const int cost = qMax( tile.byteCount() / 1024, 1 );
+                cache.tiles.insert( key, new QImage( tile ), cost );
+            }
+
+            const QPoint pos( int( tx * qwtTileSize - ox - rect.left() ),
+                int( ty * qwtTileSize - oy - rect.top() ) );
+
+            painter.drawImage( pos, tile );
+        }
+    }
+
+    painter.end();
+
+    return alphaImage( image );
+}
+
+/*!
+  \brief Apply the alpha value to an image
+
+  \param image Image with colors from renderImage()
+  \return Image with alpha(), or image itself when alpha() is
+          not in the range [0, 255[
+  \sa setAlpha()
+*/
+QImage QwtPlotRasterItem::alphaImage( const QImage &image ) const
+{
     if ( d_data->alpha >= 0 && d_data->alpha < 255 )
     {
-        QImage alphaImage( image.size(), QImage::Format_ARGB32 );
+        QImage rgbaImage( image.size(), QImage::Format_ARGB32 );
 
 #if QT_VERSION >= 0x040400 && !defined(QT_NO_QFUTURE)
         uint numThreads = renderThreadCount();
@@ -868,21 +1092,21 @@ QImage QwtPlotRasterItem::compose(
             if ( i == numThreads - 1 )
             {
                 tile.setHeight( image.height() - i * numRows );
-                qwtToRgba( &image, &alphaImage, tile, d_data->alpha );
+                qwtToRgba( &image, &rgbaImage, tile, d_data->alpha );
             }
             else
             {
                 futures += QtConcurrent::run(
-                    &qwtToRgba, &image, &alphaImage, tile, d_data->alpha );
+                    &qwtToRgba, &image, &rgbaImage, tile, d_data->alpha );
             }
         }
         for ( int i = 0; i < futures.size(); i++ )
             futures[i].waitForFinished();
 #else
         const QRect tile( 0, 0, image.width(), image.height() );
-        qwtToRgba( &image, &alphaImage, tile, d_data->alpha );
+        qwtToRgba( &image, &rgbaImage, tile, d_data->alpha );
 #endif
-        image = alphaImage;
+        return rgbaImage;
     }
 
     return image;
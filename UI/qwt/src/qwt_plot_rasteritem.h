@@ -56,7 +56,29 @@ public:
           of hide/show operations or manipulations of the alpha value. 
           All other situations are handled by the canvas backing store.
          */
-        PaintCache
+        PaintCache,
+
+        /*!
+          The image is composed from tiles of a fixed size, that are
+          aligned to a pixel grid in scale coordinates. As long as the
+          resolution of the scales doesn't change ( f.e. when panning )
+          the tiles can be reused and renderImage() is called for the
+          newly exposed tiles only. Resizing the canvas changes the 
+          resolution and invalidates all tiles - unless the scales are
+          adjusted to keep it ( f.e. by a QwtPlotRescaler ).
+
+          Tiles are kept in a cache, where the least recently used tiles
+          are removed, when exceeding tileCacheSize(). 
+
+          The tile cache is used in target device resolution only.
+          When the image is rendered according to the data pixels 
+          ( pixelHint() ) TileCache behaves like PaintCache.
+
+          \note Positions of the tiles are rounded to the target device
+                 pixels, what might result in an offset of up to half a 
+                 pixel.
+         */
+        TileCache
     };
 
     /*!
@@ -96,6 +118,9 @@ public:
     void setCachePolicy( CachePolicy );
     CachePolicy cachePolicy() const;
 
+    void setTileCacheSize( int kBytes );
+    int tileCacheSize() const;
+
     void invalidateCache();
 
     virtual void draw( QPainter *p,
@@ -142,6 +167,11 @@ private:
         const QRectF &imageArea, const QRectF &paintRect,
         const QSize &imageSize, bool doCache) const;
 
+    QImage composeTiles( const QwtScaleMap &, const QwtScaleMap &,
+        const QRectF &paintRect ) const;
+
+    QImage alphaImage( const QImage & ) const;
+
 
     class PrivateData;
     PrivateData *d_data;
@@ -16,6 +16,7 @@
 #include "qwt_scale_engine.h"
 #include "qwt_text.h"
 #include "qwt_text_label.h"
+#include "qwt_plot_curve.h"
 #include "qwt_math.h"
 #include <qpainter.h>
 #include <qpaintengine.h>
@@ -27,6 +28,7 @@
 #include <qstyle.h>
 #include <qstyleoption.h>
 #include <qimagewriter.h>
+#include <qpair.h>
 #ifndef QWT_NO_SVG
 #ifdef QT_SVG_LIB
 #include <qsvggenerator.h>
@@ -62,12 +64,16 @@ class QwtPlotRenderer::PrivateData
 public:
     PrivateData():
         discardFlags( QwtPlotRenderer::DiscardNone ),
-        layoutFlags( QwtPlotRenderer::DefaultLayout )
+        layoutFlags( QwtPlotRenderer::DefaultLayout ),
+        exportFlags( QwtPlotRenderer::ExportAll ),
+        seriesThreshold( 10000 )
     {
     }
 
     QwtPlotRenderer::DiscardFlags discardFlags;
     QwtPlotRenderer::LayoutFlags layoutFlags;
+    QwtPlotRenderer::ExportFlags exportFlags;
+    int seriesThreshold;
 };
 
 /*! 
@@ -178,6 +184,74 @@ QwtPlotRenderer::LayoutFlags QwtPlotRenderer::layoutFlags() const
     return d_data->layoutFlags;
 }
 
+/*!
+  Change a flag, indicating how to export huge series
+
+  \param flag Export flag to change
+  \param on On/Off
+
+  \sa ExportFlag, testExportFlag(), setExportFlags(), exportFlags()
+*/
+void QwtPlotRenderer::setExportFlag( ExportFlag flag, bool on )
+{
+    if ( on )
+        d_data->exportFlags |= flag;
+    else
+        d_data->exportFlags &= ~flag;
+}
+
+/*!
+  \return True, if flag is enabled.
+  \param flag Export flag to be tested
+  \sa ExportFlag, setExportFlag(), setExportFlags(), exportFlags()
+*/
+bool QwtPlotRenderer::testExportFlag( ExportFlag flag ) const
+{
+    return d_data->exportFlags & flag;
+}
+
+/*!
+  Set the flags, indicating how to export huge series
+
+  \param flags Export flags
+  \sa ExportFlag, setExportFlag(), testExportFlag(), exportFlags()
+*/
+void QwtPlotRenderer::setExportFlags( ExportFlags flags )
+{
+    d_data->exportFlags = flags;
+}
+
+/*!
+  \return Export flags
+  \sa ExportFlag, setExportFlags(), setExportFlag(), testExportFlag()
+*/
+QwtPlotRenderer::ExportFlags QwtPlotRenderer::exportFlags() const
+{
+    return d_data->exportFlags;
+}
+
+/*!
+  Set the minimum number of points of a curve, so that the
+  export flags are applied. The default threshold is 10000.
+
+  \param numPoints Number of points
+  \sa seriesThreshold(), setExportFlags()
+*/
+void QwtPlotRenderer::setSeriesThreshold( int numPoints )
+{
+    d_data->seriesThreshold = qMax( numPoints, 0 );
+}
+
+/*!
+  \return Minimum number of points of a curve, so that the
+          export flags are applied
+  \sa setSeriesThreshold()
+*/
+int QwtPlotRenderer::seriesThreshold() const
+{
+    return d_data->seriesThreshold;
+}
+
 /*!
   Render a plot to a file
 
@@ -770,7 +844,7 @@ void QwtPlotRenderer::renderCanvas( const QwtPlot *plot,
         painter->save();
 
         painter->setClipRect( canvasRect );
-        plot->drawItems( painter, canvasRect, map );
+        renderItems( plot, painter, canvasRect, map );
 
         painter->restore();
     }
@@ -794,7 +868,7 @@ void QwtPlotRenderer::renderCanvas( const QwtPlot *plot,
         else
             painter->setClipPath( clipPath );
 
-        plot->drawItems( painter, canvasRect, map );
+        renderItems( plot, painter, canvasRect, map );
 
         painter->restore();
     }
@@ -832,7 +906,7 @@ void QwtPlotRenderer::renderCanvas( const QwtPlot *plot,
             QwtPainter::drawBackgound( painter, innerRect, canvas );
         }
 
-        plot->drawItems( painter, innerRect, map );
+        renderItems( plot, painter, innerRect, map );
 
         painter->restore();
 
@@ -869,6 +943,59 @@ void QwtPlotRenderer::renderCanvas( const QwtPlot *plot,
     }
 }
 
+/*!
+  Render the items of the canvas, applying the export flags
+  to curves with more than seriesThreshold() points
+
+  \param plot Plot widget
+  \param painter Painter
+  \param canvasRect Canvas rectangle
+  \param maps Maps mapping between plot and paint device coordinates
+*/
+void QwtPlotRenderer::renderItems( const QwtPlot *plot, QPainter *painter,
+    const QRectF &canvasRect, const QwtScaleMap *maps ) const
+{
+    const ExportFlags flags = d_data->exportFlags;
+    if ( flags == ExportAll )
+    {
+        plot->drawItems( painter, canvasRect, maps );
+        return;
+    }
+
+    // Lines, that can't be rasterized - f.e. filled lines - 
+    // are reduced instead
+
+    QList<QwtPlotCurve::PaintAttribute> attributes;
+    attributes += QwtPlotCurve::ReducePoints;
+    if ( flags & RasterizeSeries )
+        attributes += QwtPlotCurve::ImageBuffer;
+
+    // the attributes are modified temporarily only
+    QList< QPair<QwtPlotCurve *, QwtPlotCurve::PaintAttribute> > modified;
+
+    const QwtPlotItemList items = plot->itemList( QwtPlotItem::Rtti_PlotCurve );
+    for ( int i = 0; i < items.size(); i++ )
+    {
+        QwtPlotCurve *curve = static_cast<QwtPlotCurve *>( items[i] );
+        if ( int( curve->dataSize() ) <= d_data->seriesThreshold )
+            continue;
+
+        for ( int j = 0; j < attributes.size(); j++ )
+        {
+            if ( !curve->testPaintAttribute( attributes[j] ) )
+            {
+                curve->setPaintAttribute( attributes[j], true );
+                modified += qMakePair( curve, attributes[j] );
+            }
+        }
+    }
+
+    plot->drawItems( painter, canvasRect, maps );
+
+    for ( int i = 0; i < modified.size(); i++ )
+        modified[i].first->setPaintAttribute( modified[i].second, false );
+}
+
 /*!
    Calculated the scale maps for rendering the canvas
 
@@ -93,6 +93,42 @@ public:
     //! Layout flags
     typedef QFlags<LayoutFlag> LayoutFlags;
 
+    /*!
+       \brief Flags for exporting huge series
+       
+       The flags are applied to all curves with more points than
+       seriesThreshold(). Axes, texts and all other items are
+       rendered as usual - f.e. as vectors, when exporting to SVG or PDF.
+
+       Neither flag reduces curves of the Steps style, fitted curves
+       or the symbols of a curve: they are always exported with all
+       their points.
+
+       \sa setExportFlag(), testExportFlag(), setSeriesThreshold()
+     */
+    enum ExportFlag
+    {
+        //! Render all points
+        ExportAll       = 0x00,
+
+        /*! 
+          Reduce the lines of a curve to the resolution of the
+          paint device - see QwtPlotCurve::ReducePoints
+         */
+        ReduceSeries    = 0x01,
+
+        /*! 
+          Render the lines, sticks or dots of a curve to an image, that 
+          is embedded in the document - see QwtPlotCurve::ImageBuffer.
+          Lines with a brush, that can't be rasterized, are reduced
+          like with ReduceSeries.
+         */
+        RasterizeSeries = 0x02
+    };
+
+    //! Export flags
+    typedef QFlags<ExportFlag> ExportFlags;
+
     explicit QwtPlotRenderer( QObject * = NULL );
     virtual ~QwtPlotRenderer();
 
@@ -108,6 +144,15 @@ public:
     void setLayoutFlags( LayoutFlags flags );
     LayoutFlags layoutFlags() const;
 
+    void setExportFlag( ExportFlag flag, bool on = true );
+    bool testExportFlag( ExportFlag flag ) const;
+
+    void setExportFlags( ExportFlags flags );
+    ExportFlags exportFlags() const;
+
+    void setSeriesThreshold( int numPoints );
+    int seriesThreshold() const;
+
     void renderDocument( QwtPlot *, const QString &fileName,
         const QSizeF &sizeMM, int resolution = 85 );
 
@@ -159,6 +204,9 @@ private:
     bool updateCanvasMargins( QwtPlot *,
         const QRectF &, const QwtScaleMap maps[] ) const;
 
+    void renderItems( const QwtPlot *, QPainter *,
+        const QRectF &canvasRect, const QwtScaleMap *maps ) const;
+
 private:
     class PrivateData;
     PrivateData *d_data;
@@ -166,5 +214,6 @@ private:
 
 Q_DECLARE_OPERATORS_FOR_FLAGS( QwtPlotRenderer::DiscardFlags )
 Q_DECLARE_OPERATORS_FOR_FLAGS( QwtPlotRenderer::LayoutFlags )
+Q_DECLARE_OPERATORS_FOR_FLAGS( QwtPlotRenderer::ExportFlags )
 
 #endif
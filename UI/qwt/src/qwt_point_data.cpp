@@ -155,6 +155,229 @@ const double *QwtCPointerData::yData() const
     return d_y;
 }
 
+// QRectF::united() ignores rectangles of a single point
+static inline void qwtExtendRect( QRectF &rect, const QRectF &r )
+{
+    if ( rect.width() < 0 )
+    {
+        rect = r;
+        return;
+    }
+
+    if ( r.left() < rect.left() )
+        rect.setLeft( r.left() );
+    if ( r.right() > rect.right() )
+        rect.setRight( r.right() );
+    if ( r.top() < rect.top() )
+        rect.setTop( r.top() );
+    if ( r.bottom() > rect.bottom() )
+        rect.setBottom( r.bottom() );
+}
+
+class QwtChunkedPointData::Chunk
+{
+public:
+    Chunk( int capacity ):
+        boundingRect( 0.0, 0.0, -1.0, -1.0 ),
+        size( 0 )
+    {
+        points = new QPointF[capacity];
+    }
+
+    ~Chunk()
+    {
+        delete[] points;
+    }
+
+    void append( const QPointF &point )
+    {
+        points[size++] = point;
+        qwtExtendRect( boundingRect, QRectF( point, QSizeF( 0.0, 0.0 ) ) );
+    }
+
+    QPointF *points;
+    QRectF boundingRect;
+    int size;
+};
+
+/*!
+  Constructor
+
+  \param chunkSize Number of points stored in each chunk
+*/
+QwtChunkedPointData::QwtChunkedPointData( int chunkSize ):
+    d_chunkSize( qMax( chunkSize, 1 ) ),
+    d_size( 0 ),
+    d_painted( 0 )
+{
+}
+
+//! Destructor
+QwtChunkedPointData::~QwtChunkedPointData()
+{
+    qDeleteAll( d_chunks );
+}
+
+/*!
+  Append a point
+
+  \param point Point
+  \sa takeAppended()
+*/
+void QwtChunkedPointData::append( const QPointF &point )
+{
+    if ( d_chunks.isEmpty() || d_chunks.last()->size == d_chunkSize )
+        d_chunks += new Chunk( d_chunkSize );
+
+    Chunk *chunk = d_chunks.last();
+    chunk->append( point );
+
+    d_size++;
+
+    qwtExtendRect( d_boundingRect, QRectF( point, QSizeF( 0.0, 0.0 ) ) );
+}
+
+/*!
+  Append an array of points
+
+  \param points Array of points
+  \param numPoints Number of points
+*/
+void QwtChunkedPointData::append( const QPointF *points, int numPoints )
+{
+    for ( int i = 0; i < numPoints; i++ )
+        append( points[i] );
+}
+
+/*!
+  \brief Remove the oldest chunks
+
+  The indexes of the remaining points are shifted by
+  the number of removed points.
+
+  \param numChunks Number of chunks to be removed
+*/
+void QwtChunkedPointData::removeChunks( int numChunks )
+{
+    numChunks = qMin( numChunks, d_chunks.size() );
+    if ( numChunks <= 0 )
+        return;
+
+    size_t numPoints = 0;
+    for ( int i = 0; i < numChunks; i++ )
+    {
+        numPoints += d_chunks[i]->size;
+        delete d_chunks[i];
+    }
+
+    d_chunks.remove( 0, numChunks );
+
+    d_size -= numPoints;
+    d_painted = ( d_painted > numPoints ) ? d_painted - numPoints : 0;
+
+    updateBoundingRect();
+}
+
+//! Remove all points
+void QwtChunkedPointData::clear()
+{
+    removeChunks( d_chunks.size() );
+}
+
+//! \return Number of points
+size_t QwtChunkedPointData::size() const
+{
+    return d_size;
+}
+
+/*!
+  Return the sample at position i
+
+  \param index Index
+  \return Sample at position i
+*/
+QPointF QwtChunkedPointData::sample( size_t index ) const
+{
+    // all chunks beside the last one are completely filled
+    const Chunk *chunk = d_chunks[ int( index / d_chunkSize ) ];
+    return chunk->points[ index % d_chunkSize ];
+}
+
+/*!
+  \return Bounding rectangle of all points, that is updated,
+          whenever points are appended or removed.
+*/
+QRectF QwtChunkedPointData::boundingRect() const
+{
+    return d_boundingRect;
+}
+
+//! \return Capacity of a chunk
+int QwtChunkedPointData::chunkSize() const
+{
+    return d_chunkSize;
+}
+
+//! \return Number of chunks
+int QwtChunkedPointData::chunkCount() const
+{
+    return d_chunks.size();
+}
+
+/*!
+  \return Points of a chunk. The pointer is valid until the 
+          chunk is removed.
+  \param chunk Index of the chunk
+
+  \sa chunkLength(), chunkCount()
+*/
+const QPointF *QwtChunkedPointData::chunkData( int chunk ) const
+{
+    return d_chunks[chunk]->points;
+}
+
+/*!
+  \return Number of points in a chunk
+  \param chunk Index of the chunk
+*/
+int QwtChunkedPointData::chunkLength( int chunk ) const
+{
+    return d_chunks[chunk]->size;
+}
+
+/*!
+  \brief Range of points appended since the previous call
+
+  The range starts with the last point of the previous range,
+  so that lines are connected, when painting them with 
+  QwtPlotDirectPainter::drawSeries().
+
+  \param from Index of the first point to be painted
+  \param to Index of the last point to be painted
+
+  \return False, when no point has been appended
+*/
+bool QwtChunkedPointData::takeAppended( int &from, int &to )
+{
+    if ( d_painted >= d_size )
+        return false;
+
+    from = int( d_painted > 0 ? d_painted - 1 : 0 );
+    to = int( d_size - 1 );
+
+    d_painted = d_size;
+
+    return true;
+}
+
+void QwtChunkedPointData::updateBoundingRect()
+{
+    d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
+
+    for ( int i = 0; i < d_chunks.size(); i++ )
+        qwtExtendRect( d_boundingRect, d_chunks[i]->boundingRect );
+}
+
 /*!
    Constructor
 
@@ -56,6 +56,69 @@ private:
     size_t d_size;
 };
 
+/*!
+  \brief Append-only point data organized in chunks
+
+  QwtChunkedPointData stores the points in chunks of a fixed
+  capacity. Appending a point never reallocates or copies
+  previously appended points, so the memory of a chunk - see
+  chunkData() - stays valid until it is removed by removeChunks() 
+  or clear().
+
+  The bounding rectangle is updated with each append, so that 
+  autoscaling doesn't need to iterate over all points.
+
+  For incremental painting the range of points, that has been appended 
+  since the last call of takeAppended(), can be passed to 
+  QwtPlotDirectPainter::drawSeries().
+
+  \code
+data->append( points, numPoints );
+
+int from, to;
+if ( data->takeAppended( from, to ) )
+    directPainter->drawSeries( curve, from, to );
+  \endcode
+*/
+class QWT_EXPORT QwtChunkedPointData: public QwtSeriesData<QPointF>
+{
+public:
+    explicit QwtChunkedPointData( int chunkSize = 4096 );
+    virtual ~QwtChunkedPointData();
+
+    void append( const QPointF & );
+    void append( const QPointF *points, int numPoints );
+
+    void removeChunks( int numChunks );
+    void clear();
+
+    virtual size_t size() const;
+    virtual QPointF sample( size_t i ) const;
+    virtual QRectF boundingRect() const;
+
+    int chunkSize() const;
+    int chunkCount() const;
+    const QPointF *chunkData( int chunk ) const;
+    int chunkLength( int chunk ) const;
+
+    bool takeAppended( int &from, int &to );
+
+private:
+    class Chunk;
+
+    // the chunks are owned, copying would delete them twice
+    QwtChunkedPointData( const QwtChunkedPointData & );
+    QwtChunkedPointData &operator=( const QwtChunkedPointData & );
+
+    void updateBoundingRect();
+
+    int d_chunkSize;
+    QVector<Chunk *> d_chunks;
+
+    size_t d_size;
+    size_t d_painted;
+};
+
 /*!
   \brief Synthetic point data
 
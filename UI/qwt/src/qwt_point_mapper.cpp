@@ -10,6 +10,7 @@
 #include "qwt_point_mapper.h"
 #include "qwt_scale_map.h"
 #include "qwt_pixel_matrix.h"
+#include "qwt_clipper.h"
 #include <qpolygon.h>
 #include <qimage.h>
 #include <qpen.h>
@@ -23,6 +24,11 @@
 
 #if !defined(QT_NO_QFUTURE)
 #define QWT_USE_THREADS 0
+
+// The tiles of qwtRenderTiled() are disjoint rows of the image,
+// each painted by its own QPainter. Unlike the dots of toImage()
+// no pixel is written by more than one thread.
+#define QWT_USE_TILE_THREADS 1
 #endif
 
 #endif
@@ -65,6 +71,212 @@ static void qwtRenderDots(
     }
 }
 
+class QwtLinesCommand
+{
+public:
+    QPen pen;
+    bool antialiased;
+    bool sticks;
+};
+
+// Rasterizing the lines/sticks, that have been assigned to a tile. 
+// The image is a band of rows of the final image sharing its memory, 
+// so that tiles rendered in parallel don't need to be merged.
+
+static void qwtRenderLines( const QwtLinesCommand &command,
+    const QRect &tile, const QVector<QPolygonF> *polylines, QImage *image )
+{
+    QPainter painter( image );
+    painter.translate( -tile.topLeft() );
+    painter.setPen( command.pen );
+    painter.setRenderHint( QPainter::Antialiasing, command.antialiased );
+
+    if ( command.sticks )
+    {
+        for ( int i = 0; i < polylines->size(); i++ )
+        {
+            const QPolygonF &stick = polylines->at( i );
+            painter.drawLine( stick[0], stick[1] );
+        }
+    }
+    else
+    {
+        // lines of points outside might still be painted inside the tile
+        const qreal pw = qMax( qreal( 1.0 ), command.pen.widthF() );
+        const QRectF clipRect = QRectF( tile ).adjusted( -pw, -pw, pw, pw );
+
+        for ( int i = 0; i < polylines->size(); i++ )
+        {
+            const QPolygonF clipped = QwtClipper::clipPolygonF( 
+                clipRect, polylines->at( i ), false );
+
+            painter.drawPolyline( clipped );
+        }
+    }
+}
+
+// Find the tiles, that are intersected by the vertical
+// range [y1, y2]. Calculations are done in double, as the
+// points are unclipped paint device coordinates.
+
+static inline bool qwtTileRange( double y1, double y2, 
+    const QRect &rect, int numRows, int numTiles, double margin,
+    int &tile1, int &tile2 )
+{
+    const double top = qMin( y1, y2 ) - margin - rect.top();
+    const double bottom = qMax( y1, y2 ) + margin - rect.top();
+
+    if ( !( bottom >= 0.0 && top <= rect.height() ) )
+        return false; // outside or NaN
+
+    const double maxTile = numTiles - 1;
+
+    tile1 = static_cast<int>( qBound( 0.0, top / numRows, maxTile ) );
+    tile2 = static_cast<int>( qBound( 0.0, bottom / numRows, maxTile ) );
+
+    return true;
+}
+
+static QImage qwtRenderTiled( const QRect &rect,
+    const QPolygonF &points, const QwtLinesCommand &command, 
+    Qt::Orientation orientation, double baseline, uint numThreads )
+{
+    QImage image( rect.size(), QImage::Format_ARGB32_Premultiplied );
+    image.fill( Qt::transparent );
+
+#if QWT_USE_TILE_THREADS
+    if ( numThreads == 0 )
+        numThreads = QThread::idealThreadCount();
+
+    if ( numThreads <= 0 )
+        numThreads = 1;
+
+    numThreads = qMin( numThreads, uint( qMax( image.height(), 1 ) ) );
+#else
+    numThreads = 1;
+#endif
+
+    const int numTiles = numThreads;
+    const int numRows = qMax( image.height() / numTiles, 1 );
+    const double margin = qMax( qreal( 1.0 ), command.pen.widthF() );
+
+    // Distributing the lines to the tiles in one pass, so that
+    // each thread has to iterate over its own lines only
+
+    QVector< QVector<QPolygonF> > tilePolylines( numTiles );
+
+    int tile1, tile2;
+
+    if ( command.sticks )
+    {
+        for ( int i = 0; i < points.size(); i++ )
+        {
+            const QPointF &p = points[i];
+
+            QPolygonF stick( 2 );
+            stick[1] = p;
+
+            if ( orientation == Qt::Horizontal )
+            {
+                stick[0] = QPointF( baseline, p.y() );
+                if ( !qwtTileRange( p.y(), p.y(), rect, 
+                    numRows, numTiles, margin, tile1, tile2 ) )
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                stick[0] = QPointF( p.x(), baseline );
+                if ( !qwtTileRange( p.y(), baseline, rect, 
+                    numRows, numTiles, margin, tile1, tile2 ) )
+                {
+                    continue;
+                }
+            }
+
+            for ( int tile = tile1; tile <= tile2; tile++ )
+                tilePolylines[tile] += stick;
+        }
+    }
+    else
+    {
+        // index of the last point appended to the current 
+        // polyline of a tile
+
+        QVector<int> lastIndex( numTiles, -1 );
+
+        for ( int i = 1; i < points.size(); i++ )
+        {
+            const QPointF &p1 = points[i - 1];
+            const QPointF &p2 = points[i];
+
+            if ( !qwtTileRange( p1.y(), p2.y(), rect, 
+                numRows, numTiles, margin, tile1, tile2 ) )
+            {
+                continue;
+            }
+
+            for ( int tile = tile1; tile <= tile2; tile++ )
+            {
+                QVector<QPolygonF> &polylines = tilePolylines[tile];
+
+                if ( lastIndex[tile] == i - 1 )
+                    polylines.last() += p2;
+                else
+                    polylines += QPolygonF() << p1 << p2;
+
+                lastIndex[tile] = i;
+            }
+        }
+    }
+
+    if ( numTiles <= 1 )
+    {
+        qwtRenderLines( command, rect, &tilePolylines[0], &image );
+        return image;
+    }
+
+#if QWT_USE_TILE_THREADS
+    QList<QImage> tileImages;
+    QList< QFuture<void> > futures;
+
+    for ( int i = 0; i < numTiles; i++ )
+    {
+        QRect tile( rect.left(), rect.top() + i * numRows, 
+            rect.width(), numRows );
+        if ( i == numTiles - 1 )
+            tile.setBottom( rect.bottom() );
+
+        const int row = tile.top() - rect.top();
+        tileImages += QImage( image.scanLine( row ), tile.width(), 
+            tile.height(), image.bytesPerLine(), image.format() );
+    }
+
+    for ( int i = 0; i < numTiles; i++ )
+    {
+        QRect tile( rect.left(), rect.top() + i * numRows, 
+            rect.width(), numRows );
+
+        if ( i == numTiles - 1 )
+        {
+            tile.setBottom( rect.bottom() );
+            qwtRenderLines( command, tile, &tilePolylines[i], &tileImages[i] );
+        }
+        else
+        {
+            futures += QtConcurrent::run( &qwtRenderLines, 
+                command, tile, &tilePolylines[i], &tileImages[i] );
+        }
+    }
+
+    for ( int i = 0; i < futures.size(); i++ )
+        futures[i].waitForFinished();
+#endif
+
+    return image;
+}
+
 static inline int qwtRoundValue( double value )
 {
 #if 1
@@ -105,6 +317,28 @@ struct QwtNoRoundF
     }
 };
 
+// Samples are fetched and mapped in blocks, so that the scale maps
+// can transform all coordinates of a block in one call
+
+static const int qwtBlockSize = 256;
+
+static inline void qwtTransformBlock(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, int from, int count,
+    double *xValues, double *yValues )
+{
+    for ( int i = 0; i < count; i++ )
+    {
+        const QPointF sample = series->sample( from + i );
+
+        xValues[i] = sample.x();
+        yValues[i] = sample.y();
+    }
+
+    xMap.transform( xValues, xValues, count );
+    yMap.transform( yValues, yValues, count );
+}
+
 // mapping points without any filtering - beside checking
 // the bounding rectangle
 
@@ -118,6 +352,9 @@ static inline Polygon qwtToPoints(
     Polygon polyline( to - from + 1 );
     Point *points = polyline.data();
 
+    double xValues[qwtBlockSize];
+    double yValues[qwtBlockSize];
+
     int numPoints = 0;
 
     if ( boundingRect.isValid() )
@@ -126,19 +363,23 @@ static inline Polygon qwtToPoints(
         // filtering out all points outside of
         // the bounding rectangle
 
-        for ( int i = from; i <= to; i++ )
+        for ( int i = from; i <= to; i += qwtBlockSize )
         {
-            const QPointF sample = series->sample( i );
+            const int n = qMin( qwtBlockSize, to - i + 1 );
+            qwtTransformBlock( xMap, yMap, series, i, n, xValues, yValues );
 
-            const double x = xMap.transform( sample.x() );
-            const double y = yMap.transform( sample.y() );
-
-            if ( boundingRect.contains( x, y ) )
+            for ( int j = 0; j < n; j++ )
             {
-                points[ numPoints ].rx() = round( x );
-                points[ numPoints ].ry() = round( y );
+                const double x = xValues[j];
+                const double y = yValues[j];
 
-                numPoints++;
+                if ( boundingRect.contains( x, y ) )
+                {
+                    points[ numPoints ].rx() = round( x );
+                    points[ numPoints ].ry() = round( y );
+
+                    numPoints++;
+                }
             }
         }
 
@@ -149,17 +390,18 @@ static inline Polygon qwtToPoints(
         // simply iterating over all values
         // without any filtering
 
-        for ( int i = from; i <= to; i++ )
+        for ( int i = from; i <= to; i += qwtBlockSize )
         {
-            const QPointF sample = series->sample( i );
+            const int n = qMin( qwtBlockSize, to - i + 1 );
+            qwtTransformBlock( xMap, yMap, series, i, n, xValues, yValues );
 
-            const double x = xMap.transform( sample.x() );
-            const double y = yMap.transform( sample.y() );
-
-            points[ numPoints ].rx() = round( x );
-            points[ numPoints ].ry() = round( y );
+            for ( int j = 0; j < n; j++ )
+            {
+                points[ numPoints ].rx() = round( xValues[j] );
+                points[ numPoints ].ry() = round( yValues[j] );
 
-            numPoints++;
+                numPoints++;
+            }
         }
     }
 
@@ -204,21 +446,22 @@ static inline Polygon qwtToPolylineFiltered(
     Polygon polyline( to - from + 1 );
     Point *points = polyline.data();
 
-    const QPointF sample0 = series->sample( from );
-
-    points[0].rx() = round( xMap.transform( sample0.x() ) );
-    points[0].ry() = round( yMap.transform( sample0.y() ) );
+    double xValues[qwtBlockSize];
+    double yValues[qwtBlockSize];
 
-    int pos = 0;
-    for ( int i = from + 1; i <= to; i++ )
+    int pos = -1;
+    for ( int i = from; i <= to; i += qwtBlockSize )
     {
-        const QPointF sample = series->sample( i );
+        const int n = qMin( qwtBlockSize, to - i + 1 );
+        qwtTransformBlock( xMap, yMap, series, i, n, xValues, yValues );
 
-        const Point p( round( xMap.transform( sample.x() ) ),
-            round( yMap.transform( sample.y() ) ) );
+        for ( int j = 0; j < n; j++ )
+        {
+            const Point p( round( xValues[j] ), round( yValues[j] ) );
 
-        if ( points[pos] != p )
-            points[++pos] = p;
+            if ( pos < 0 || points[pos] != p )
+                points[++pos] = p;
+        }
     }
 
     polyline.resize( pos + 1 );
@@ -258,20 +501,27 @@ static inline Polygon qwtToPointsFiltered(
 
     QwtPixelMatrix pixelMatrix( boundingRect.toAlignedRect() );
 
+    double xValues[qwtBlockSize];
+    double yValues[qwtBlockSize];
+
     int numPoints = 0;
-    for ( int i = from; i <= to; i++ )
+    for ( int i = from; i <= to; i += qwtBlockSize )
     {
-        const QPointF sample = series->sample( i );
+        const int n = qMin( qwtBlockSize, to - i + 1 );
+        qwtTransformBlock( xMap, yMap, series, i, n, xValues, yValues );
 
-        const int x = qwtRoundValue( xMap.transform( sample.x() ) );
-        const int y = qwtRoundValue( yMap.transform( sample.y() ) );
-
-        if ( pixelMatrix.testAndSetPixel( x, y, true ) == false )
+        for ( int j = 0; j < n; j++ )
         {
-            points[ numPoints ].rx() = x;
-            points[ numPoints ].ry() = y;
+            const int x = qwtRoundValue( xValues[j] );
+            const int y = qwtRoundValue( yValues[j] );
+
+            if ( pixelMatrix.testAndSetPixel( x, y, true ) == false )
+            {
+                points[ numPoints ].rx() = x;
+                points[ numPoints ].ry() = y;
 
-            numPoints++;
+                numPoints++;
+            }
         }
     }
 
@@ -719,3 +969,91 @@ QImage QwtPointMapper::toImage(
 
     return image;
 }
+
+/*!
+  \brief Translate a series into a QImage displaying a polyline
+
+  The image is split into horizontal tiles, that are rasterized in
+  parallel threads. The segments of the polyline are distributed
+  to the tiles they intersect in one pass, before each thread
+  paints the segments of its tile.
+
+  \param xMap x map
+  \param yMap y map
+  \param series Series of points to be mapped
+  \param from Index of the first point to be painted
+  \param to Index of the last point to be painted
+  \param pen Pen used for drawing the lines
+  \param antialiased True, when the lines should be displayed
+                     antialiased
+  \param numThreads Number of threads to be used for rendering.
+                   If numThreads is set to 0, the system specific
+                   ideal thread count is used.
+
+  \return Image displaying the series
+  \sa toImage(), toSticksImage()
+*/
+QImage QwtPointMapper::toPolylineImage(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, int from, int to, 
+    const QPen &pen, bool antialiased, uint numThreads ) const
+{
+    const QPolygonF points = toPolygonF( xMap, yMap, series, from, to );
+
+    QwtLinesCommand command;
+    command.pen = pen;
+    command.antialiased = antialiased;
+    command.sticks = false;
+
+    return qwtRenderTiled( d_data->boundingRect.toAlignedRect(), 
+        points, command, Qt::Vertical, 0.0, numThreads );
+}
+
+/*!
+  \brief Translate a series into a QImage displaying sticks
+
+  The image is split into horizontal tiles, that are rasterized in
+  parallel threads. The sticks are distributed to the tiles they
+  intersect in one pass, before each thread paints the sticks 
+  of its tile.
+
+  \param xMap x map
+  \param yMap y map
+  \param series Series of points to be mapped
+  \param from Index of the first point to be painted
+  \param to Index of the last point to be painted
+  \param orientation Qt::Vertical for sticks from the baseline
+                     to the y coordinate of the points, 
+                     Qt::Horizontal for sticks to the x coordinate.
+  \param baseline Baseline of the sticks in scale coordinates
+  \param pen Pen used for drawing the sticks
+  \param antialiased True, when the sticks should be displayed
+                     antialiased
+  \param numThreads Number of threads to be used for rendering.
+                   If numThreads is set to 0, the system specific
+                   ideal thread count is used.
+
+  \return Image displaying the series
+  \sa toImage(), toPolylineImage()
+*/
+QImage QwtPointMapper::toSticksImage(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, int from, int to, 
+    Qt::Orientation orientation, double baseline,
+    const QPen &pen, bool antialiased, uint numThreads ) const
+{
+    const QPolygonF points = toPolygonF( xMap, yMap, series, from, to );
+
+    double base = ( orientation == Qt::Horizontal ) 
+        ? xMap.transform( baseline ) : yMap.transform( baseline );
+    if ( d_data->flags & RoundPoints )
+        base = qwtRoundValue( base );
+
+    QwtLinesCommand command;
+    command.pen = pen;
+    command.antialiased = antialiased;
+    command.sticks = true;
+
+    return qwtRenderTiled( d_data->boundingRect.toAlignedRect(), 
+        points, command, orientation, base, numThreads );
+}
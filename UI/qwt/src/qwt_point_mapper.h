@@ -79,6 +79,15 @@ public:
         const QwtSeriesData<QPointF> *series, int from, int to, 
         const QPen &, bool antialiased, uint numThreads ) const;
 
+    QImage toPolylineImage( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QwtSeriesData<QPointF> *series, int from, int to, 
+        const QPen &, bool antialiased, uint numThreads ) const;
+
+    QImage toSticksImage( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QwtSeriesData<QPointF> *series, int from, int to, 
+        Qt::Orientation, double baseline,
+        const QPen &, bool antialiased, uint numThreads ) const;
+
 private:
     class PrivateData;
     PrivateData *d_data;
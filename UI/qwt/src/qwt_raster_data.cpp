@@ -10,6 +10,13 @@
 #include "qwt_raster_data.h"
 #include "qwt_point_3d.h"
 #include <qnumeric.h>
+#include <qvector.h>
+#include <qmutex.h>
+#if QT_VERSION >= 0x040400
+#include <qthread.h>
+#include <qfuture.h>
+#include <qtconcurrentrun.h>
+#endif
 
 class QwtRasterData::ContourPlane
 {
@@ -155,14 +162,244 @@ inline QPointF QwtRasterData::ContourPlane::intersection(
     return QPointF( x, y );
 }
 
+static const int qwtContourTileRows = 64;
+
+class QwtContourTile
+{
+public:
+    QwtContourTile():
+        firstRow( 0 ),
+        lastRow( 0 ),
+        valid( false )
+    {
+    }
+
+    int firstRow;
+    int lastRow;
+    bool valid;
+
+    QwtRasterData::ContourLines lines;
+};
+
+class QwtContourCommand
+{
+public:
+    QwtContourCommand( const QwtRasterData *data,
+            const QRectF &rect, const QSize &raster,
+            const QList<double> &levels, 
+            QwtRasterData::ConrecFlags flags ):
+        d_data( data ),
+        d_rect( rect ),
+        d_levels( levels ),
+        d_numColumns( raster.width() ),
+        d_ignoreOutOfRange( false )
+    {
+        d_dx = rect.width() / raster.width();
+        d_dy = rect.height() / raster.height();
+
+        d_ignoreOnPlane = flags & QwtRasterData::IgnoreAllVerticesOnLevel;
+
+        d_range = data->interval( Qt::ZAxis );
+        if ( d_range.isValid() )
+            d_ignoreOutOfRange = flags & QwtRasterData::IgnoreOutOfRange;
+    }
+
+    void contourTiles( QwtContourTile *tiles, 
+        const QVector<int> &pending, int first, int step ) const
+    {
+        for ( int i = first; i < pending.size(); i += step )
+        {
+            QwtContourTile &tile = tiles[ pending[i] ];
+
+            tile.lines.clear();
+            contourRows( tile.firstRow, tile.lastRow, &tile.lines );
+            tile.valid = true;
+        }
+    }
+
+private:
+    void contourRows( int firstRow, int lastRow, 
+        QwtRasterData::ContourLines *contourLines ) const
+    {
+        typedef QwtRasterData::ContourPlane ContourPlane;
+
+        for ( int y = firstRow; y < lastRow; y++ )
+        {
+            enum Position
+            {
+                Center,
+
+                TopLeft,
+                TopRight,
+                BottomRight,
+                BottomLeft,
+
+                NumPositions
+            };
+
+            QwtPoint3D xy[NumPositions];
+
+            for ( int x = 0; x < d_numColumns - 1; x++ )
+            {
+                const QPointF pos( d_rect.x() + x * d_dx,
+                    d_rect.y() + y * d_dy );
+
+                if ( x == 0 )
+                {
+                    xy[TopRight].setX( pos.x() );
+                    xy[TopRight].setY( pos.y() );
+                    xy[TopRight].setZ(
+                        d_data->value( xy[TopRight].x(), xy[TopRight].y() )
+                    );
+
+                    xy[BottomRight].setX( pos.x() );
+                    xy[BottomRight].setY( pos.y() + d_dy );
+                    xy[BottomRight].setZ(
+                        d_data->value(
+                            xy[BottomRight].x(), xy[BottomRight].y() )
+                    );
+                }
+
+                xy[TopLeft] = xy[TopRight];
+                xy[BottomLeft] = xy[BottomRight];
+
+                xy[TopRight].setX( pos.x() + d_dx );
+                xy[TopRight].setY( pos.y() );
+                xy[BottomRight].setX( pos.x() + d_dx );
+                xy[BottomRight].setY( pos.y() + d_dy );
+
+                xy[TopRight].setZ(
+                    d_data->value( xy[TopRight].x(), xy[TopRight].y() )
+                );
+                xy[BottomRight].setZ(
+                    d_data->value( xy[BottomRight].x(), xy[BottomRight].y() )
+                );
+
+                double zMin = xy[TopLeft].z();
+                double zMax = zMin;
+                double zSum = zMin;
+
+                for ( int i = TopRight; i <= BottomLeft; i++ )
+                {
+                    const double z = xy[i].z();
+
+                    zSum += z;
+                    if ( z < zMin )
+                        zMin = z;
+                    if ( z > zMax )
+                        zMax = z;
+                }
+
+                if ( qIsNaN( zSum ) )
+                {
+                    // one of the points is NaN
+                    continue;
+                }
+
+                if ( d_ignoreOutOfRange )
+                {
+                    if ( !d_range.contains( zMin ) ||
+                        !d_range.contains( zMax ) )
+                    {
+                        continue;
+                    }
+                }
+
+                if ( zMax < d_levels[0] ||
+                    zMin > d_levels[d_levels.size() - 1] )
+                {
+                    continue;
+                }
+
+                xy[Center].setX( pos.x() + 0.5 * d_dx );
+                xy[Center].setY( pos.y() + 0.5 * d_dy );
+                xy[Center].setZ( 0.25 * zSum );
+
+                const int numLevels = d_levels.size();
+                for ( int l = 0; l < numLevels; l++ )
+                {
+                    const double level = d_levels[l];
+                    if ( level < zMin || level > zMax )
+                        continue;
+                    QPolygonF &lines = (*contourLines)[level];
+                    const ContourPlane plane( level );
+
+                    QPointF line[2];
+                    QwtPoint3D vertex[3];
+
+                    for ( int m = TopLeft; m < NumPositions; m++ )
+                    {
+                        vertex[0] = xy[m];
+                        vertex[1] = xy[0];
+                        vertex[2] = xy[m != BottomLeft ? m + 1 : TopLeft];
+
+                        const bool intersects =
+                            plane.intersect( vertex, line, d_ignoreOnPlane );
+                        if ( intersects )
+                        {
+                            lines += line[0];
+                            lines += line[1];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    const QwtRasterData *d_data;
+
+    const QRectF d_rect;
+    const QList<double> d_levels;
+    const int d_numColumns;
+
+    double d_dx;
+    double d_dy;
+
+    bool d_ignoreOnPlane;
+    bool d_ignoreOutOfRange;
+    QwtInterval d_range;
+};
+
+class QwtRasterData::PrivateData
+{
+public:
+    PrivateData():
+        numThreads( 1 )
+    {
+    }
+
+    class ContourCache
+    {
+    public:
+        ContourCache():
+            flags( 0 )
+        {
+        }
+
+        QRectF rect;
+        QSize raster;
+        QList<double> levels;
+        QwtRasterData::ConrecFlags flags;
+
+        QVector<QwtContourTile> tiles;
+    };
+
+    uint numThreads;
+
+    QMutex mutex;
+    ContourCache contourCache;
+};
+
 //! Constructor
 QwtRasterData::QwtRasterData()
 {
+    d_data = new PrivateData();
 }
 
 //! Destructor
 QwtRasterData::~QwtRasterData()
 {
+    delete d_data;
 }
 
 /*!
@@ -245,6 +482,81 @@ QRectF QwtRasterData::pixelHint( const QRectF &area ) const
     return QRectF(); 
 }
 
+/*!
+   \brief Set the number of threads used by contourLines()
+
+   The raster is split into bands of rows, that are contoured
+   in parallel. As value() is called from several threads at the same
+   time it has to be thread safe, what is also expected from 
+   QwtPlotRasterItem::setRenderThreadCount().
+
+   \param numThreads Number of threads to be used for calculating
+                     contour lines. If numThreads is set to 0, the
+                     system specific ideal thread count is used.
+
+   The default thread count is 1 ( = no additional threads )
+
+   \sa contourThreadCount(), contourLines()
+*/
+void QwtRasterData::setContourThreadCount( uint numThreads )
+{
+    d_data->numThreads = numThreads;
+}
+
+/*!
+   \return Number of threads to be used by contourLines()
+   \sa setContourThreadCount()
+*/
+uint QwtRasterData::contourThreadCount() const
+{
+    return d_data->numThreads;
+}
+
+/*!
+   \brief Invalidate cached contour lines
+
+   When contourLines() is called with the IncrementalUpdate flag
+   the contour lines of each band of rows are kept and
+   reused as long as rectangle, raster, levels and flags don't change.
+   When the values of some rows have been modified - f.e. a waterfall,
+   where new rows have been filled in - only the bands intersecting 
+   these rows have to be recalculated.
+
+   \param yInterval Interval of the modified rows in plot coordinates.
+                    An invalid interval invalidates all bands.
+
+   \sa contourLines(), ConrecFlag
+*/
+void QwtRasterData::invalidateContourRows( const QwtInterval &yInterval )
+{
+    QMutexLocker locker( &d_data->mutex );
+
+    PrivateData::ContourCache &cache = d_data->contourCache;
+    if ( !yInterval.isValid() )
+    {
+        cache.tiles.clear();
+        return;
+    }
+
+    if ( cache.tiles.isEmpty() )
+        return;
+
+    const double dy = cache.rect.height() / cache.raster.height();
+
+    for ( int i = 0; i < cache.tiles.size(); i++ )
+    {
+        QwtContourTile &tile = cache.tiles[i];
+
+        // a band of cells covers the rows from firstRow to lastRow
+        const QwtInterval tileInterval(
+            cache.rect.y() + tile.firstRow * dy,
+            cache.rect.y() + tile.lastRow * dy );
+
+        if ( tileInterval.intersects( yInterval ) )
+            tile.valid = false;
+    }
+}
+
 /*!
    Calculate contour lines
 
@@ -257,6 +569,14 @@ QRectF QwtRasterData::pixelHint( const QRectF &area ) const
 
    An adaption of CONREC, a simple contouring algorithm.
    http://local.wasp.uwa.edu.au/~pbourke/papers/conrec/
+
+   The raster is divided into bands of rows, that are contoured
+   independently - in parallel, when contourThreadCount() is not 1.
+   Adjacent bands share their border row, so the segments of both
+   bands meet at identical positions and the result is identical
+   to contouring the raster in one pass.
+
+   \sa setContourThreadCount(), invalidateContourRows()
 */
 QwtRasterData::ContourLines QwtRasterData::contourLines(
     const QRectF &rect, const QSize &raster,
@@ -267,138 +587,97 @@ QwtRasterData::ContourLines QwtRasterData::contourLines(
     if ( levels.size() == 0 || !rect.isValid() || !raster.isValid() )
         return contourLines;
 
-    const double dx = rect.width() / raster.width();
-    const double dy = rect.height() / raster.height();
+    const bool incremental = flags & IncrementalUpdate;
+    flags &= ~IncrementalUpdate;
 
-    const bool ignoreOnPlane =
-        flags & QwtRasterData::IgnoreAllVerticesOnLevel;
+    QMutexLocker locker( incremental ? &d_data->mutex : NULL );
 
-    const QwtInterval range = interval( Qt::ZAxis );
-    bool ignoreOutOfRange = false;
-    if ( range.isValid() )
-        ignoreOutOfRange = flags & IgnoreOutOfRange;
+    QVector<QwtContourTile> localTiles;
+    QVector<QwtContourTile> &tiles = 
+        incremental ? d_data->contourCache.tiles : localTiles;
 
-    QwtRasterData *that = const_cast<QwtRasterData *>( this );
-    that->initRaster( rect, raster );
-
-    for ( int y = 0; y < raster.height() - 1; y++ )
+    if ( incremental )
     {
-        enum Position
+        PrivateData::ContourCache &cache = d_data->contourCache;
+        if ( cache.rect != rect || cache.raster != raster 
+            || cache.levels != levels || cache.flags != flags )
         {
-            Center,
-
-            TopLeft,
-            TopRight,
-            BottomRight,
-            BottomLeft,
-
-            NumPositions
-        };
-
-        QwtPoint3D xy[NumPositions];
+            cache.rect = rect;
+            cache.raster = raster;
+            cache.levels = levels;
+            cache.flags = flags;
+            cache.tiles.clear();
+        }
+    }
 
-        for ( int x = 0; x < raster.width() - 1; x++ )
+    if ( tiles.isEmpty() )
+    {
+        const int numRows = raster.height() - 1;
+        for ( int row = 0; row < numRows; row += qwtContourTileRows )
         {
-            const QPointF pos( rect.x() + x * dx, rect.y() + y * dy );
+            QwtContourTile tile;
+            tile.firstRow = row;
+            tile.lastRow = qMin( row + qwtContourTileRows, numRows );
 
-            if ( x == 0 )
-            {
-                xy[TopRight].setX( pos.x() );
-                xy[TopRight].setY( pos.y() );
-                xy[TopRight].setZ(
-                    value( xy[TopRight].x(), xy[TopRight].y() )
-                );
-
-                xy[BottomRight].setX( pos.x() );
-                xy[BottomRight].setY( pos.y() + dy );
-                xy[BottomRight].setZ(
-                    value( xy[BottomRight].x(), xy[BottomRight].y() )
-                );
-            }
-
-            xy[TopLeft] = xy[TopRight];
-            xy[BottomLeft] = xy[BottomRight];
-
-            xy[TopRight].setX( pos.x() + dx );
-            xy[TopRight].setY( pos.y() );
-            xy[BottomRight].setX( pos.x() + dx );
-            xy[BottomRight].setY( pos.y() + dy );
+            tiles += tile;
+        }
+    }
 
-            xy[TopRight].setZ(
-                value( xy[TopRight].x(), xy[TopRight].y() )
-            );
-            xy[BottomRight].setZ(
-                value( xy[BottomRight].x(), xy[BottomRight].y() )
-            );
+    QVector<int> pending;
+    for ( int i = 0; i < tiles.size(); i++ )
+    {
+        if ( !tiles[i].valid )
+            pending += i;
+    }
 
-            double zMin = xy[TopLeft].z();
-            double zMax = zMin;
-            double zSum = zMin;
+    if ( !pending.isEmpty() )
+    {
+        const QwtContourCommand command( this, rect, raster, levels, flags );
 
-            for ( int i = TopRight; i <= BottomLeft; i++ )
-            {
-                const double z = xy[i].z();
+        QwtRasterData *that = const_cast<QwtRasterData *>( this );
+        that->initRaster( rect, raster );
 
-                zSum += z;
-                if ( z < zMin )
-                    zMin = z;
-                if ( z > zMax )
-                    zMax = z;
-            }
+        uint numThreads = d_data->numThreads;
 
-            if ( qIsNaN( zSum ) )
-            {
-                // one of the points is NaN
-                continue;
-            }
+#if QT_VERSION >= 0x040400 && !defined(QT_NO_QFUTURE)
+        if ( numThreads == 0 )
+            numThreads = QThread::idealThreadCount();
 
-            if ( ignoreOutOfRange )
-            {
-                if ( !range.contains( zMin ) || !range.contains( zMax ) )
-                    continue;
-            }
+        if ( numThreads <= 0 )
+            numThreads = 1;
 
-            if ( zMax < levels[0] ||
-                zMin > levels[levels.size() - 1] )
-            {
-                continue;
-            }
+        numThreads = qMin( numThreads, uint( pending.size() ) );
 
-            xy[Center].setX( pos.x() + 0.5 * dx );
-            xy[Center].setY( pos.y() + 0.5 * dy );
-            xy[Center].setZ( 0.25 * zSum );
+        QList< QFuture<void> > futures;
+        for ( uint i = 1; i < numThreads; i++ )
+        {
+            futures += QtConcurrent::run( &command, 
+                &QwtContourCommand::contourTiles,
+                tiles.data(), pending, int( i ), int( numThreads ) );
+        }
 
-            const int numLevels = levels.size();
-            for ( int l = 0; l < numLevels; l++ )
-            {
-                const double level = levels[l];
-                if ( level < zMin || level > zMax )
-                    continue;
-                QPolygonF &lines = contourLines[level];
-                const ContourPlane plane( level );
+        command.contourTiles( tiles.data(), pending, 0, numThreads );
 
-                QPointF line[2];
-                QwtPoint3D vertex[3];
+        for ( int i = 0; i < futures.size(); i++ )
+            futures[i].waitForFinished();
+#else
+        numThreads = 1;
+        command.contourTiles( tiles.data(), pending, 0, 1 );
+#endif
 
-                for ( int m = TopLeft; m < NumPositions; m++ )
-                {
-                    vertex[0] = xy[m];
-                    vertex[1] = xy[0];
-                    vertex[2] = xy[m != BottomLeft ? m + 1 : TopLeft];
+        that->discardRaster();
+    }
 
-                    const bool intersects =
-                        plane.intersect( vertex, line, ignoreOnPlane );
-                    if ( intersects )
-                    {
-                        lines += line[0];
-                        lines += line[1];
-                    }
-                }
-            }
+    // stitching the bands in order of their rows
+    for ( int i = 0; i < tiles.size(); i++ )
+    {
+        const ContourLines &tileLines = tiles[i].lines;
+        for ( ContourLines::const_iterator it = tileLines.begin();
+            it != tileLines.end(); ++it )
+        {
+            contourLines[ it.key() ] += it.value();
         }
     }
 
-    that->discardRaster();
-
     return contourLines;
 }
@@ -42,7 +42,14 @@ public:
         IgnoreAllVerticesOnLevel = 0x01,
 
         //! Ignore all values, that are out of range
-        IgnoreOutOfRange = 0x02
+        IgnoreOutOfRange = 0x02,
+
+        /*!
+          Reuse the contour lines of all bands of rows, that have not
+          been invalidated by invalidateContourRows() since the
+          previous call with the same parameters.
+         */
+        IncrementalUpdate = 0x04
     };
 
     //! Flags to modify the contour algorithm
@@ -66,6 +73,11 @@ public:
     */
     virtual double value( double x, double y ) const = 0;
 
+    void setContourThreadCount( uint numThreads );
+    uint contourThreadCount() const;
+
+    void invalidateContourRows( const QwtInterval &yInterval );
+
     virtual ContourLines contourLines( const QRectF &rect,
         const QSize &raster, const QList<double> &levels,
         ConrecFlags ) const;
@@ -79,6 +91,9 @@ private:
     QwtRasterData &operator=( const QwtRasterData & );
 
     QwtInterval d_intervals[3];
+
+    class PrivateData;
+    PrivateData *d_data;
 };
 
 /*!
@@ -9,14 +9,73 @@
 
 #include "qwt_sampling_thread.h"
 #include "qwt_system_clock.h"
+#include <qatomic.h>
+
+// time before a deadline, that is spent spinning in PreciseTiming mode
+static const double qwtSpinTime = 1.0; // ms
+
+static inline int qwtLoadAcquire( const QAtomicInt &atomic )
+{
+#if QT_VERSION >= 0x050000
+    return atomic.loadAcquire();
+#else
+    return const_cast<QAtomicInt &>( atomic ).fetchAndAddAcquire( 0 );
+#endif
+}
+
+static inline void qwtStoreRelease( QAtomicInt &atomic, int value )
+{
+#if QT_VERSION >= 0x050000
+    atomic.storeRelease( value );
+#else
+    atomic.fetchAndStoreRelease( value );
+#endif
+}
 
 class QwtSamplingThread::PrivateData
 {
 public:
+    PrivateData():
+        timingMode( QwtSamplingThread::RelativeTiming ),
+        buffer( NULL ),
+        bufferSize( 0 ),
+        head( 0 ),
+        tail( 0 ),
+        notified( 0 ),
+        dropped( 0 ),
+        overruns( 0 ),
+        jitter( 0 ),
+        maxJitter( 0 ),
+        resetRequested( 0 )
+    {
+    }
+
+    ~PrivateData()
+    {
+        delete[] buffer;
+    }
+
     QwtSystemClock clock;
 
     double interval;
     bool isStopped;
+
+    QwtSamplingThread::TimingMode timingMode;
+
+    // single producer/single consumer ring buffer
+    QPointF *buffer;
+    int bufferSize; // power of 2
+
+    QAtomicInt head; // written by the sampling thread only
+    QAtomicInt tail; // written by the consumer only
+    QAtomicInt notified;
+
+    // statistics, written by the sampling thread only
+    QAtomicInt dropped;
+    QAtomicInt overruns;
+    QAtomicInt jitter; // moving average in 1/16 us
+    QAtomicInt maxJitter; // us
+    QAtomicInt resetRequested;
 };
 
 
@@ -27,6 +86,8 @@ QwtSamplingThread::QwtSamplingThread( QObject *parent ):
     d_data = new PrivateData;
     d_data->interval = 1000; // 1 second
     d_data->isStopped = true;
+
+    setBufferSize( 4096 );
 }
 
 //! Destructor
@@ -71,6 +132,193 @@ double QwtSamplingThread::elapsed() const
     return d_data->clock.elapsed();
 }
 
+/*!
+   Set the timing mode
+
+   \param mode Timing mode
+   \sa timingMode(), jitter(), overrunCount()
+*/
+void QwtSamplingThread::setTimingMode( TimingMode mode )
+{
+    d_data->timingMode = mode;
+}
+
+/*!
+   \return Timing mode
+   \sa setTimingMode()
+*/
+QwtSamplingThread::TimingMode QwtSamplingThread::timingMode() const
+{
+    return d_data->timingMode;
+}
+
+/*!
+   \brief Set the capacity of the handoff buffer
+
+   The size is rounded up to a power of 2. All samples, that have 
+   not been taken yet, are discarded. The buffer size can't be changed
+   while the thread is running.
+
+   The default size is 4096.
+
+   \param size Maximum number of samples, that can be stored
+               until takeSamples() is called
+   \sa bufferSize(), appendSample()
+*/
+void QwtSamplingThread::setBufferSize( int size )
+{
+    if ( isRunning() )
+        return;
+
+    int bufferSize = 1;
+    while ( bufferSize < size )
+        bufferSize <<= 1;
+
+    delete[] d_data->buffer;
+    d_data->buffer = new QPointF[bufferSize];
+    d_data->bufferSize = bufferSize;
+
+    qwtStoreRelease( d_data->head, 0 );
+    qwtStoreRelease( d_data->tail, 0 );
+    qwtStoreRelease( d_data->notified, 0 );
+}
+
+/*!
+   \return Capacity of the handoff buffer
+   \sa setBufferSize()
+*/
+int QwtSamplingThread::bufferSize() const
+{
+    return d_data->bufferSize;
+}
+
+/*!
+   \brief Hand over a sample to the consumer
+
+   appendSample() is intended to be called from sample(). It never
+   blocks: when the buffer is full the sample is dropped.
+
+   \param sample Sample
+   \return false, when the sample has been dropped
+   \sa takeSamples(), samplesReady(), droppedSamples()
+*/
+bool QwtSamplingThread::appendSample( const QPointF &sample )
+{
+    const uint head = qwtLoadAcquire( d_data->head );
+    const uint tail = qwtLoadAcquire( d_data->tail );
+
+    if ( head - tail >= uint( d_data->bufferSize ) )
+    {
+        d_data->dropped.fetchAndAddRelaxed( 1 );
+        return false;
+    }
+
+    d_data->buffer[ head & ( d_data->bufferSize - 1 ) ] = sample;
+    qwtStoreRelease( d_data->head, int( head + 1 ) );
+
+    if ( d_data->notified.testAndSetOrdered( 0, 1 ) )
+        Q_EMIT samplesReady();
+
+    return true;
+}
+
+/*!
+   \brief Take all samples, that have been appended
+
+   takeSamples() has to be called from one thread only ( usually the
+   GUI thread ). It never blocks the sampling thread.
+
+   \param samples Vector, where the samples are appended
+   \return Number of samples, that have been taken
+   \sa appendSample(), samplesReady()
+*/
+int QwtSamplingThread::takeSamples( QVector<QPointF> &samples )
+{
+    /*
+      reset before reading, so that later samples are notified again.
+      The exchange is a full barrier: a plain store could be reordered
+      with the load of head, missing a sample appended in between,
+      that would never be notified.
+     */
+    d_data->notified.fetchAndStoreOrdered( 0 );
+
+    const uint tail = qwtLoadAcquire( d_data->tail );
+    const uint head = qwtLoadAcquire( d_data->head );
+
+    const int numSamples = int( head - tail );
+    if ( numSamples <= 0 )
+        return 0;
+
+    const uint mask = d_data->bufferSize - 1;
+
+    samples.reserve( samples.size() + numSamples );
+    for ( uint i = tail; i != head; i++ )
+        samples += d_data->buffer[ i & mask ];
+
+    qwtStoreRelease( d_data->tail, int( head ) );
+
+    return numSamples;
+}
+
+/*!
+   \return Moving average of the deviation (in ms) between 
+           the period of 2 calls of sample() and interval()
+   \sa maxJitter(), resetStatistics()
+*/
+double QwtSamplingThread::jitter() const
+{
+    return qwtLoadAcquire( d_data->jitter ) / 16000.0;
+}
+
+/*!
+   \return Maximum deviation (in ms) between the period of 
+           2 calls of sample() and interval()
+   \sa jitter(), resetStatistics()
+*/
+double QwtSamplingThread::maxJitter() const
+{
+    return qwtLoadAcquire( d_data->maxJitter ) / 1000.0;
+}
+
+/*!
+   \return Number of intervals, where sample() has taken longer
+           than interval(), so that the next sample was late
+   \sa resetStatistics()
+*/
+int QwtSamplingThread::overrunCount() const
+{
+    return qwtLoadAcquire( d_data->overruns );
+}
+
+/*!
+   \return Number of samples, that have been dropped by appendSample(),
+           because the handoff buffer was full
+   \sa setBufferSize(), resetStatistics()
+*/
+int QwtSamplingThread::droppedSamples() const
+{
+    return qwtLoadAcquire( d_data->dropped );
+}
+
+/*!
+   Reset jitter, overrun and drop statistics. The reset is executed
+   by the sampling thread before the next sample.
+*/
+void QwtSamplingThread::resetStatistics()
+{
+    if ( isRunning() )
+    {
+        qwtStoreRelease( d_data->resetRequested, 1 );
+    }
+    else
+    {
+        qwtStoreRelease( d_data->dropped, 0 );
+        qwtStoreRelease( d_data->overruns, 0 );
+        qwtStoreRelease( d_data->jitter, 0 );
+        qwtStoreRelease( d_data->maxJitter, 0 );
+    }
+}
+
 /*!
    Terminate the collecting thread
    \sa QThread::start(), run()
@@ -89,18 +337,81 @@ void QwtSamplingThread::run()
     d_data->clock.start();
     d_data->isStopped = false;
 
+    double deadline = 0.0;
+    double lastElapsed = -1.0;
+
     while ( !d_data->isStopped )
     {
+        if ( d_data->resetRequested.testAndSetOrdered( 1, 0 ) )
+        {
+            qwtStoreRelease( d_data->dropped, 0 );
+            qwtStoreRelease( d_data->overruns, 0 );
+            qwtStoreRelease( d_data->jitter, 0 );
+            qwtStoreRelease( d_data->maxJitter, 0 );
+        }
+
         const double elapsed = d_data->clock.elapsed();
         sample( elapsed / 1000.0 );
 
-        if ( d_data->interval > 0.0 )
+        if ( lastElapsed >= 0.0 && d_data->interval > 0.0 )
+            updateStatistics( elapsed - lastElapsed, false );
+
+        lastElapsed = elapsed;
+
+        if ( d_data->interval <= 0.0 )
+            continue;
+
+        if ( d_data->timingMode == PreciseTiming )
+        {
+            deadline += d_data->interval;
+
+            double now = d_data->clock.elapsed();
+            if ( now > deadline )
+            {
+                // skipping the missed deadlines
+                updateStatistics( 0.0, true );
+
+                while ( deadline < now )
+                    deadline += d_data->interval;
+            }
+
+            const double msecs = deadline - now - qwtSpinTime;
+            if ( msecs > 0.0 )
+                usleep( qRound( 1000.0 * msecs ) );
+
+            while ( d_data->clock.elapsed() < deadline )
+                ;
+        }
+        else
         {
             const double msecs =
                 d_data->interval - ( d_data->clock.elapsed() - elapsed );
 
             if ( msecs > 0.0 )
                 usleep( qRound( 1000.0 * msecs ) );
+            else
+                updateStatistics( 0.0, true );
         }
     }
 }
+
+void QwtSamplingThread::updateStatistics( double period, bool overrun )
+{
+    if ( overrun )
+    {
+        d_data->overruns.fetchAndAddRelaxed( 1 );
+        return;
+    }
+
+    const int deviation = qRound( 1000.0 * qAbs( period - d_data->interval ) );
+
+    /*
+      exponential moving average over ~16 periods, kept in 1/16 us
+      so that deviations below 16 us are not lost by the division
+     */
+    const int jitter = qwtLoadAcquire( d_data->jitter );
+    qwtStoreRelease( d_data->jitter, jitter - ( jitter >> 4 ) + deviation );
+
+    if ( deviation > qwtLoadAcquire( d_data->maxJitter ) )
+        qwtStoreRelease( d_data->maxJitter, deviation );
+}
@@ -3,6 +3,8 @@
 
 #include "qwt_global.h"
 #include <qthread.h>
+#include <qvector.h>
+#include <qpoint.h>
 
 /*!
   \brief A thread collecting samples at regular intervals.
@@ -14,6 +16,12 @@
   QwtSamplingThread starts a thread calling periodically sample(),
   to collect and store ( or emit ) a single sample.
 
+  Samples can be handed over to the GUI thread with appendSample()
+  and takeSamples(). Both sides operate on a ring buffer with a single
+  producer and a single consumer without any locking, so the sampling
+  thread never waits for a reader, that is painting. When the buffer
+  is full new samples are dropped - see droppedSamples().
+
   \sa QwtPlotCurve, QwtPlotSeriesItem
 */
 class QWT_EXPORT QwtSamplingThread: public QThread
@@ -21,11 +29,56 @@ class QWT_EXPORT QwtSamplingThread: public QThread
     Q_OBJECT
 
 public:
+    /*!
+      \brief Timing modes
+      \sa setTimingMode()
+     */
+    enum TimingMode
+    {
+        /*!
+          After each sample() the thread sleeps for the rest of
+          the interval. Delays sum up over time.
+         */
+        RelativeTiming,
+
+        /*!
+          sample() is called at absolute deadlines, that are multiples
+          of the interval. The thread sleeps until shortly before
+          the deadline and spins for the remaining time, trading
+          CPU load for precision.
+         */
+        PreciseTiming
+    };
+
     virtual ~QwtSamplingThread();
 
     double interval() const;
     double elapsed() const;
 
+    void setTimingMode( TimingMode );
+    TimingMode timingMode() const;
+
+    void setBufferSize( int size );
+    int bufferSize() const;
+
+    int takeSamples( QVector<QPointF> & );
+
+    double jitter() const;
+    double maxJitter() const;
+    int overrunCount() const;
+    int droppedSamples() const;
+
+    void resetStatistics();
+
+Q_SIGNALS:
+    /*!
+      Emitted, when a sample has been appended to an empty handoff
+      buffer or to a buffer, that has not been read since the previous
+      notification. So the consumer is notified once for a batch
+      of samples, that can be retrieved by takeSamples().
+     */
+    void samplesReady();
+
 public Q_SLOTS:
     void setInterval( double interval );
     void stop();
@@ -42,7 +95,11 @@ protected:
      */
     virtual void sample( double elapsed ) = 0;
 
+    bool appendSample( const QPointF & );
+
 private:
+    void updateStatistics( double period, bool overrun );
+
     class PrivateData;
     PrivateData *d_data;
 };
@@ -12,6 +12,10 @@
 #include <qrect.h>
 #include <qdebug.h>
 
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
 /*!
   \brief Constructor
 
@@ -139,6 +143,49 @@ void QwtScaleMap::updateFactor()
         d_cnv = ( d_p2 - d_p1 ) / ( ts2 - d_ts1 );
 }
 
+/*!
+  Transform an array of values from scale to paint device coordinates
+
+  The result is the same as calling transform( double ) for each
+  value, but the transformation is called once for all values and
+  the linear part of the mapping is done 2 values at a time with
+  SSE2 instructions, when available.
+
+  \param values Values relative to the coordinates of the scale
+  \param result Transformed values, might be identical to values
+  \param count Number of values
+
+  \sa QwtTransform::transformValues()
+*/
+void QwtScaleMap::transform( const double *values, 
+    double *result, int count ) const
+{
+    const double *s = values;
+    if ( d_transform )
+    {
+        d_transform->transformValues( values, result, count );
+        s = result;
+    }
+
+    int i = 0;
+
+#if defined( __SSE2__ )
+    const __m128d p1 = _mm_set1_pd( d_p1 );
+    const __m128d ts1 = _mm_set1_pd( d_ts1 );
+    const __m128d cnv = _mm_set1_pd( d_cnv );
+
+    for ( ; i + 1 < count; i += 2 )
+    {
+        __m128d v = _mm_loadu_pd( s + i );
+        v = _mm_add_pd( p1, _mm_mul_pd( _mm_sub_pd( v, ts1 ), cnv ) );
+        _mm_storeu_pd( result + i, v );
+    }
+#endif
+
+    for ( ; i < count; i++ )
+        result[i] = d_p1 + ( s[i] - d_ts1 ) * d_cnv;
+}
+
 /*!
    Transform a rectangle from scale to paint coordinates
 
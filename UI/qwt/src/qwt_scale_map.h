@@ -46,6 +46,8 @@ public:
     double transform( double s ) const;
     double invTransform( double p ) const;
 
+    void transform( const double *values, double *result, int count ) const;
+
     double p1() const;
     double p2() const;
 
@@ -16,6 +16,11 @@
 #include <qpixmap.h>
 #include <qpaintengine.h>
 #include <qmath.h>
+#include <qhash.h>
+#include <qthread.h>
+#include <qdatastream.h>
+#include <qcoreapplication.h>
+#include <typeinfo>
 #ifndef QWT_NO_SVG
 #include <qsvgrenderer.h>
 #endif
@@ -767,6 +772,142 @@ static inline void qwtDrawHexagonSymbols( QPainter *painter,
     }
 }
 
+/*
+  A process wide pixmap, where the pixmaps of symbols with
+  the SharedCache policy are packed row by row.
+ */
+class QwtSymbolAtlas
+{
+public:
+    enum { Extent = 1024 };
+
+    QwtSymbolAtlas():
+        d_generation( 0 )
+    {
+        clear();
+    }
+
+    static QwtSymbolAtlas *instance()
+    {
+        static QwtSymbolAtlas atlas;
+        return &atlas;
+    }
+
+    QRect sprite( const QByteArray &key ) const
+    {
+        return d_sprites.value( key );
+    }
+
+    // reserve space for a new sprite
+    QRect allocate( const QByteArray &key, const QSize &size )
+    {
+        if ( size.width() > Extent / 4 || size.height() > Extent / 4 )
+            return QRect();
+
+        if ( d_x + size.width() > Extent )
+        {
+            d_x = 0;
+            d_y += d_rowHeight;
+            d_rowHeight = 0;
+        }
+
+        if ( d_y + size.height() > Extent )
+        {
+            // full: all sprites will be rendered again
+            clear();
+        }
+
+        const QRect rect( d_x, d_y, size.width(), size.height() );
+
+        d_x += size.width();
+        d_rowHeight = qMax( d_rowHeight, size.height() );
+
+        d_sprites.insert( key, rect );
+
+        return rect;
+    }
+
+    QPixmap &pixmap()
+    {
+        return d_pixmap;
+    }
+
+    int generation() const
+    {
+        return d_generation;
+    }
+
+private:
+    void clear()
+    {
+        // sprites are allocated in logical pixels, the pixmap
+        // has the resolution of the screen
+        d_pixmap = QwtPainter::backingStore( NULL, QSize( Extent, Extent ) );
+        d_pixmap.fill( Qt::transparent );
+
+        d_sprites.clear();
+        d_x = d_y = d_rowHeight = 0;
+
+        d_generation++;
+    }
+
+    QPixmap d_pixmap;
+    QHash<QByteArray, QRect> d_sprites;
+
+    int d_x;
+    int d_y;
+    int d_rowHeight;
+
+    int d_generation;
+};
+
+static void qwtBlitSymbols( QPainter *painter, const QPixmap &pixmap,
+    const QRect &sourceRect, const QPoint &offset,
+    const QPointF *points, int numPoints )
+{
+    // sourceRect is in logical pixels, while the source of
+    // drawPixmap() or drawPixmapFragments() is in pixels of the pixmap
+
+#if QT_VERSION >= 0x050000
+    const qreal pixelRatio = pixmap.devicePixelRatio();
+#else
+    const qreal pixelRatio = 1.0;
+#endif
+
+    const QRectF source( sourceRect.x() * pixelRatio, 
+        sourceRect.y() * pixelRatio, sourceRect.width() * pixelRatio, 
+        sourceRect.height() * pixelRatio );
+
+#if QT_VERSION >= 0x040700
+    // all symbols in one call, so that the paint engine can batch them
+    const double cx = offset.x() + 0.5 * sourceRect.width();
+    const double cy = offset.y() + 0.5 * sourceRect.height();
+
+    const qreal scale = 1.0 / pixelRatio;
+
+    QVector<QPainter::PixmapFragment> fragments( numPoints );
+    for ( int i = 0; i < numPoints; i++ )
+    {
+        const QPointF pos( qRound( points[i].x() ) + cx, 
+            qRound( points[i].y() ) + cy );
+
+        fragments[i] = QPainter::PixmapFragment::create( 
+            pos, source, scale, scale );
+    }
+
+    painter->drawPixmapFragments( fragments.constData(), numPoints, pixmap );
+#else
+    for ( int i = 0; i < numPoints; i++ )
+    {
+        const int left = qRound( points[i].x() ) + offset.x();
+        const int top = qRound( points[i].y() ) + offset.y();
+
+        painter->drawPixmap( QRectF( left, top, 
+            sourceRect.width(), sourceRect.height() ), pixmap, source );
+    }
+#endif
+}
+
 class QwtSymbol::PrivateData
 {
 public:
@@ -779,6 +920,8 @@ public:
         isPinPointEnabled( false )
     {
         cache.policy = QwtSymbol::AutoCache;
+        cache.generation = -1;
+        cache.renderHints = 0;
 #ifndef QWT_NO_SVG
         svg.renderer = NULL;
 #endif
@@ -830,6 +973,11 @@ public:
         QwtSymbol::CachePolicy policy;
         QPixmap pixmap;
 
+        // position in QwtSymbolAtlas
+        QRect sprite;
+        int generation;
+        int renderHints;
+
     } cache;
 };
 
@@ -1317,7 +1465,8 @@ void QwtSymbol::drawSymbols( QPainter *painter,
     if ( QwtPainter::roundingAlignment( painter ) &&
         !painter->transform().isScaling() )
     {
-        if ( d_data->cache.policy == QwtSymbol::Cache )
+        if ( d_data->cache.policy == QwtSymbol::Cache ||
+            d_data->cache.policy == QwtSymbol::SharedCache )
         {
             useCache = true;
         }
@@ -1357,6 +1506,18 @@ void QwtSymbol::drawSymbols( QPainter *painter,
     {
         const QRect br = boundingRect();
 
+        if ( d_data->cache.policy == QwtSymbol::SharedCache )
+        {
+            const QRect sprite = atlasSprite( painter, br );
+            if ( sprite.isValid() )
+            {
+                qwtBlitSymbols( painter, QwtSymbolAtlas::instance()->pixmap(),
+                    sprite, br.topLeft(), points, numPoints );
+
+                return;
+            }
+        }
+
         const QRect rect( 0, 0, br.width(), br.height() );
         
         if ( d_data->cache.pixmap.isNull() )
@@ -1372,16 +1533,8 @@ void QwtSymbol::drawSymbols( QPainter *painter,
             renderSymbols( &p, &pos, 1 );
         }
 
-        const int dx = br.left();
-        const int dy = br.top();
-
-        for ( int i = 0; i < numPoints; i++ )
-        {
-            const int left = qRound( points[i].x() ) + dx;
-            const int top = qRound( points[i].y() ) + dy;
-
-            painter->drawPixmap( left, top, d_data->cache.pixmap );
-        }
+        qwtBlitSymbols( painter, d_data->cache.pixmap, 
+            rect, br.topLeft(), points, numPoints );
     }
     else
     {
@@ -1740,6 +1893,73 @@ void QwtSymbol::invalidateCache()
 {
     if ( !d_data->cache.pixmap.isNull() )
         d_data->cache.pixmap = QPixmap();
+
+    d_data->cache.generation = -1;
+}
+
+/*!
+  Find or render the pixmap of the symbol in the shared atlas
+
+  \param painter Painter, used for the render hints
+  \param br Bounding rectangle of the symbol
+  \return Position of the symbol in the atlas, or an invalid 
+          rectangle, when the atlas can't be used.
+*/
+QRect QwtSymbol::atlasSprite( const QPainter *painter, const QRect &br ) const
+{
+    if ( d_data->style < QwtSymbol::Ellipse || 
+        d_data->style > QwtSymbol::Hexagon )
+    {
+        return QRect();
+    }
+
+    // derived classes might render differently for the same key
+    if ( typeid( *this ) != typeid( QwtSymbol ) )
+        return QRect();
+
+    // QPixmap must not be used outside of the GUI thread
+    const QCoreApplication *app = QCoreApplication::instance();
+    if ( app == NULL || QThread::currentThread() != app->thread() )
+        return QRect();
+
+    QwtSymbolAtlas *atlas = QwtSymbolAtlas::instance();
+
+    const int renderHints = painter->renderHints();
+
+    if ( d_data->cache.generation == atlas->generation() &&
+        d_data->cache.renderHints == renderHints )
+    {
+        return d_data->cache.sprite;
+    }
+
+    QByteArray key;
+    {
+        QDataStream stream( &key, QIODevice::WriteOnly );
+        stream << int( d_data->style ) << br 
+            << d_data->pen << d_data->brush << renderHints;
+    }
+
+    QRect sprite = atlas->sprite( key );
+    if ( !sprite.isValid() )
+    {
+        sprite = atlas->allocate( key, br.size() );
+        if ( sprite.isValid() )
+        {
+            QPainter p( &atlas->pixmap() );
+            p.setRenderHints( painter->renderHints() );
+            p.setClipRect( sprite );
+            p.translate( sprite.topLeft() - br.topLeft() );
+
+            const QPointF pos;
+            renderSymbols( &p, &pos, 1 );
+        }
+    }
+
+    d_data->cache.sprite = sprite;
+    d_data->cache.generation = atlas->generation();
+    d_data->cache.renderHints = renderHints;
+
+    return sprite;
 }
 
 /*!
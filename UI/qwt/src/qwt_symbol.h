@@ -160,7 +160,21 @@ public:
            - The symbol is rendered with the software 
              renderer ( QPaintEngine::Raster )
          */
-        AutoCache
+        AutoCache,
+
+        /*!
+           Like Cache, but the pixmap is stored in a process wide atlas,
+           that is shared by all symbols with the same style, size, pen
+           and brush. As all symbols of a series are blitted from the 
+           same pixmap, plots with many curves using the same markers
+           need less memory and can be painted faster.
+
+           SharedCache is available for the built-in styles from
+           Ellipse to Hexagon of QwtSymbol itself ( not for derived
+           classes ), when painting in the GUI thread.
+           Otherwise it is handled like Cache.
+         */
+        SharedCache
     };
 
 public:
@@ -226,6 +240,8 @@ private:
     QwtSymbol( const QwtSymbol & );
     QwtSymbol &operator=( const QwtSymbol & );
 
+    QRect atlasSprite( const QPainter *, const QRect & ) const;
+
     class PrivateData;
     PrivateData *d_data;
 };
@@ -0,0 +1,297 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_trace.h"
+#include "qwt_system_clock.h"
+#include <qmutex.h>
+#include <qlist.h>
+#include <qvector.h>
+#include <qthread.h>
+#include <qthreadstorage.h>
+#include <qcoreapplication.h>
+#include <qtextstream.h>
+#include <qfile.h>
+
+QAtomicInt QwtTrace::d_enabled( 0 );
+
+namespace
+{
+    class TraceEvent
+    {
+    public:
+        const char *name;
+        const char *category;
+        const char *argName;
+        int arg;
+        double start; // ms
+        double end;   // ms
+    };
+
+    /*
+      Events of a thread. The mutex is taken by its thread only,
+      unless the trace is cleared or dumped. The buffer outlives
+      the thread, so that its events can be dumped later.
+     */
+    class TraceBuffer
+    {
+    public:
+        TraceBuffer( int id, const QString &threadName ):
+            id( id ),
+            threadName( threadName ),
+            dropped( 0 )
+        {
+        }
+
+        QMutex mutex;
+        QVector<TraceEvent> events;
+
+        const int id;
+        const QString threadName;
+        int dropped;
+    };
+
+    class TraceBufferRef
+    {
+    public:
+        TraceBufferRef():
+            buffer( NULL )
+        {
+        }
+
+        TraceBuffer *buffer; // owned by TraceRegistry
+    };
+
+    class TraceRegistry
+    {
+    public:
+        TraceRegistry():
+            maxEvents( 1000000 )
+        {
+            clock.start();
+        }
+
+        ~TraceRegistry()
+        {
+            qDeleteAll( buffers );
+        }
+
+        TraceBuffer *threadBuffer()
+        {
+            TraceBufferRef &ref = storage.localData();
+            if ( ref.buffer == NULL )
+            {
+                const QThread *thread = QThread::currentThread();
+
+                QString name = thread->objectName();
+                if ( name.isEmpty() )
+                {
+                    const QCoreApplication *app = QCoreApplication::instance();
+                    if ( app && app->thread() == thread )
+                        name = "GUI";
+                    else
+                        name = thread->metaObject()->className();
+                }
+
+                QMutexLocker locker( &mutex );
+
+                ref.buffer = new TraceBuffer( buffers.size() + 1, name );
+                buffers += ref.buffer;
+            }
+
+            return ref.buffer;
+        }
+
+        QwtSystemClock clock;
+        int maxEvents;
+
+        QMutex mutex;
+        QList<TraceBuffer *> buffers;
+        QThreadStorage<TraceBufferRef> storage;
+    };
+}
+
+static TraceRegistry *qwtTraceRegistry()
+{
+    static TraceRegistry registry;
+    return &registry;
+}
+
+static QString qwtJsonString( const char *text )
+{
+    QString s = QString::fromLatin1( text ? text : "" );
+    s.replace( '\\', "\\\\" );
+    s.replace( '"', "\\\"" );
+
+    return '"' + s + '"';
+}
+
+/*!
+  Enable/Disable the recording of trace points
+
+  \param on On/Off
+  \sa isEnabled(), clear()
+*/
+void QwtTrace::setEnabled( bool on )
+{
+    if ( on )
+        qwtTraceRegistry(); // starts the clock
+
+#if QT_VERSION >= 0x050000
+    d_enabled.storeRelease( on ? 1 : 0 );
+#else
+    d_enabled.fetchAndStoreRelease( on ? 1 : 0 );
+#endif
+}
+
+/*!
+  Set the maximum number of events recorded for each thread.
+  Further events are dropped. The default setting is 1000000.
+
+  \param numEvents Maximum number of events
+  \sa maxEvents()
+*/
+void QwtTrace::setMaxEvents( int numEvents )
+{
+    qwtTraceRegistry()->maxEvents = qMax( numEvents, 0 );
+}
+
+/*!
+  \return Maximum number of events recorded for each thread
+  \sa setMaxEvents()
+*/
+int QwtTrace::maxEvents()
+{
+    return qwtTraceRegistry()->maxEvents;
+}
+
+//! Remove all events
+void QwtTrace::clear()
+{
+    TraceRegistry *registry = qwtTraceRegistry();
+
+    QMutexLocker locker( &registry->mutex );
+    for ( int i = 0; i < registry->buffers.size(); i++ )
+    {
+        TraceBuffer *buffer = registry->buffers[i];
+
+        QMutexLocker bufferLocker( &buffer->mutex );
+        buffer->events.clear();
+        buffer->dropped = 0;
+    }
+}
+
+//! \return Time of the trace clock in ms
+double QwtTrace::timestamp()
+{
+    return qwtTraceRegistry()->clock.elapsed();
+}
+
+/*!
+  Append an event to the buffer of the calling thread
+
+  \param name Name of the event
+  \param category Category of the event
+  \param start Start time, see timestamp()
+  \param end End time, see timestamp()
+  \param argName Name of an optional integer argument
+  \param arg Value of the argument
+*/
+void QwtTrace::addEvent( const char *name, const char *category,
+    double start, double end, const char *argName, int arg )
+{
+    TraceRegistry *registry = qwtTraceRegistry();
+    TraceBuffer *buffer = registry->threadBuffer();
+
+    QMutexLocker locker( &buffer->mutex );
+
+    if ( buffer->events.size() >= registry->maxEvents )
+    {
+        buffer->dropped++;
+        return;
+    }
+
+    const TraceEvent event = { name, category, argName, arg, start, end };
+    buffer->events += event;
+}
+
+/*!
+  Write the events as Chrome trace event JSON
+
+  \param device Open device
+  \return true, when the trace has been written successfully
+*/
+bool QwtTrace::writeChromeTrace( QIODevice *device )
+{
+    TraceRegistry *registry = qwtTraceRegistry();
+
+    QTextStream stream( device );
+    stream.setRealNumberNotation( QTextStream::FixedNotation );
+    stream.setRealNumberPrecision( 3 );
+
+    stream << "{\"traceEvents\":[\n";
+
+    bool first = true;
+
+    QMutexLocker locker( &registry->mutex );
+    for ( int i = 0; i < registry->buffers.size(); i++ )
+    {
+        TraceBuffer *buffer = registry->buffers[i];
+
+        QMutexLocker bufferLocker( &buffer->mutex );
+
+        if ( !first )
+            stream << ",\n";
+        first = false;
+
+        stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << buffer->id << ",\"args\":{\"name\":"
+            << qwtJsonString( buffer->threadName.toLatin1().constData() )
+            << ",\"dropped\":" << buffer->dropped << "}}";
+
+        for ( int j = 0; j < buffer->events.size(); j++ )
+        {
+            const TraceEvent &event = buffer->events[j];
+
+            // timestamps in us
+            stream << ",\n{\"name\":" << qwtJsonString( event.name )
+                << ",\"cat\":" << qwtJsonString( event.category )
+                << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                << ",\"ts\":" << event.start * 1000.0
+                << ",\"dur\":" << ( event.end - event.start ) * 1000.0;
+
+            if ( event.argName )
+            {
+                stream << ",\"args\":{" << qwtJsonString( event.argName )
+                    << ":" << event.arg << "}";
+            }
+
+            stream << "}";
+        }
+    }
+
+    stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    stream.flush();
+
+    return stream.status() == QTextStream::Ok;
+}
+
+/*!
+  Write the events as Chrome trace event JSON
+
+  \param fileName Name of the file
+  \return true, when the trace has been written successfully
+*/
+bool QwtTrace::writeChromeTrace( const QString &fileName )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+        return false;
+
+    return writeChromeTrace( &file );
+}
@@ -0,0 +1,153 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_TRACE_H
+#define QWT_TRACE_H
+
+#include "qwt_global.h"
+#include <qatomic.h>
+
+class QIODevice;
+class QString;
+
+/*!
+  \brief Collector of trace events
+
+  QwtTrace records the duration of scoped trace points - usually
+  placed with QWT_TRACE_SCOPE() - in per thread buffers, that can
+  be dumped as Chrome trace event JSON ( "chrome://tracing" or any
+  other trace viewer ) at any time.
+
+  When tracing is disabled a trace point costs the test of a global
+  flag only, so that trace points can be left in production code.
+
+  Qwt itself has trace points for QwtPlot::replot() and for the
+  QwtPlotItem::draw() calls of the plot items.
+
+  \code
+    void Loader::parse()
+    {
+        QWT_TRACE_SCOPE( "parse", "loader" );
+        ...
+    }
+
+    QwtTrace::setEnabled( true );
+    ...
+    QFile file( "trace.json" );
+    if ( file.open( QIODevice::WriteOnly ) )
+        QwtTrace::writeChromeTrace( &file );
+  \endcode
+
+  \note Names and categories are stored as pointers and have to be
+        string literals ( or live as long as the trace ).
+*/
+class QWT_EXPORT QwtTrace
+{
+public:
+    static void setEnabled( bool );
+
+    //! \return true, when trace points are recorded
+    static inline bool isEnabled()
+    {
+#if QT_VERSION >= 0x050e00
+        return d_enabled.loadRelaxed() != 0;
+#elif QT_VERSION >= 0x050000
+        return d_enabled.load() != 0;
+#else
+        return d_enabled != 0;
+#endif
+    }
+
+    static void setMaxEvents( int );
+    static int maxEvents();
+
+    static void clear();
+    static bool writeChromeTrace( QIODevice * );
+    static bool writeChromeTrace( const QString &fileName );
+
+    static double timestamp();
+    static void addEvent( const char *name, const char *category,
+        double start, double end, const char *argName = NULL, int arg = 0 );
+
+private:
+    static QAtomicInt d_enabled;
+};
+
+/*!
+  \brief A trace point, recording the lifetime of the object
+  \sa QWT_TRACE_SCOPE(), QWT_TRACE_SCOPE_ARG()
+*/
+class QwtTraceScope
+{
+public:
+    /*!
+      \param name Name of the event
+      \param category Category of the event
+      \param argName Name of an optional integer argument
+      \param arg Value of the argument
+     */
+    inline QwtTraceScope( const char *name, const char *category,
+            const char *argName = NULL, int arg = 0 ):
+        d_name( name ),
+        d_category( category ),
+        d_argName( argName ),
+        d_arg( arg ),
+        d_start( QwtTrace::isEnabled() ? QwtTrace::timestamp() : -1.0 )
+    {
+    }
+
+    inline ~QwtTraceScope()
+    {
+        if ( d_start >= 0.0 )
+        {
+            QwtTrace::addEvent( d_name, d_category,
+                d_start, QwtTrace::timestamp(), d_argName, d_arg );
+        }
+    }
+
+private:
+    const char *d_name;
+    const char *d_category;
+    const char *d_argName;
+    int d_arg;
+    double d_start;
+};
+
+#define QWT_TRACE_CONCAT2( a, b ) a ## b
+#define QWT_TRACE_CONCAT( a, b ) QWT_TRACE_CONCAT2( a, b )
+
+/*!
+  Record the time until the end of the enclosing scope
+  as an event of the trace
+
+  \param name Name of the event
+  \param category Category of the event
+
+  \sa QWT_TRACE_SCOPE_ARG(), QwtTraceScope
+ */
+#define QWT_TRACE_SCOPE( name, category ) \
+    QwtTraceScope QWT_TRACE_CONCAT( qwtTraceScope, __LINE__ )( \
+        name, category )
+
+/*!
+  Record the time until the end of the enclosing scope
+  as an event of the trace with an integer argument
+
+  \param name Name of the event
+  \param category Category of the event
+  \param argName Name of the argument
+  \param arg Value of the argument
+
+  \sa QWT_TRACE_SCOPE(), QwtTraceScope
+ */
+#define QWT_TRACE_SCOPE_ARG( name, category, argName, arg ) \
+    QwtTraceScope QWT_TRACE_CONCAT( qwtTraceScope, __LINE__ )( \
+        name, category, argName, arg )
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "qwt_transform.h"
 #include "qwt_math.h"
+#include <string.h>
 
 #if QT_VERSION < 0x040601
 #define qExp(x) ::exp(x)
@@ -39,6 +40,24 @@ double QwtTransform::bounded( double value ) const
     return value;
 }
 
+/*!
+  Transform an array of values
+
+  The default implementation calls transform() for each value.
+  Derived classes might reimplement it to avoid the overhead
+  of a virtual call per value.
+
+  \param values Values to be transformed
+  \param result Transformed values, might be identical to values
+  \param count Number of values
+ */
+void QwtTransform::transformValues( const double *values,
+    double *result, int count ) const
+{
+    for ( int i = 0; i < count; i++ )
+        result[i] = transform( values[i] );
+}
+
 //! Constructor
 QwtNullTransform::QwtNullTransform():
     QwtTransform()
@@ -68,6 +87,18 @@ double QwtNullTransform::invTransform( double value ) const
     return value;
 }
 
+/*!
+  \param values Values to be transformed
+  \param result Copy of values
+  \param count Number of values
+ */
+void QwtNullTransform::transformValues( const double *values,
+    double *result, int count ) const
+{
+    if ( result != values )
+        ::memcpy( result, values, count * sizeof( double ) );
+}
+
 //! \return Clone of the transformation
 QwtTransform *QwtNullTransform::copy() const
 {
@@ -103,6 +134,18 @@ double QwtLogTransform::invTransform( double value ) const
     return qExp( value );
 }
 
+/*!
+  \param values Values to be transformed
+  \param result log() of values
+  \param count Number of values
+ */
+void QwtLogTransform::transformValues( const double *values,
+    double *result, int count ) const
+{
+    for ( int i = 0; i < count; i++ )
+        result[i] = ::log( values[i] );
+}
+
 /*! 
   \param value Value to be bounded
   \return qBound( LogMin, value, LogMax )
@@ -158,6 +201,26 @@ double QwtPowerTransform::invTransform( double value ) const
         return qPow( value, d_exponent );
 }
 
+/*!
+  \param values Values to be transformed
+  \param result Exponentiations preserving the sign
+  \param count Number of values
+ */
+void QwtPowerTransform::transformValues( const double *values,
+    double *result, int count ) const
+{
+    const double exponent = 1.0 / d_exponent;
+
+    for ( int i = 0; i < count; i++ )
+    {
+        const double value = values[i];
+        if ( value < 0.0 )
+            result[i] = -qPow( -value, exponent );
+        else
+            result[i] = qPow( value, exponent );
+    }
+}
+
 //! \return Clone of the transformation
 QwtTransform *QwtPowerTransform::copy() const
 {
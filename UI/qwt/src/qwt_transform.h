@@ -72,6 +72,9 @@ public:
      */
     virtual double invTransform( double value ) const = 0;
 
+    virtual void transformValues( const double *values, 
+        double *result, int count ) const;
+
     //! Virtualized copy operation
     virtual QwtTransform *copy() const = 0;
 };
@@ -91,6 +94,9 @@ public:
     virtual double transform( double value ) const;
     virtual double invTransform( double value ) const;
 
+    virtual void transformValues( const double *values, 
+        double *result, int count ) const;
+
     virtual QwtTransform *copy() const;
 };
 /*!
@@ -111,6 +117,9 @@ public:
     virtual double transform( double value ) const;
     virtual double invTransform( double value ) const;
 
+    virtual void transformValues( const double *values, 
+        double *result, int count ) const;
+
     virtual double bounded( double value ) const;
 
     virtual QwtTransform *copy() const;
@@ -136,6 +145,9 @@ public:
     virtual double transform( double value ) const;
     virtual double invTransform( double value ) const;
 
+    virtual void transformValues( const double *values, 
+        double *result, int count ) const;
+
     virtual QwtTransform *copy() const;
 
 private:
@@ -45,6 +45,7 @@ HEADERS += \
     qwt_text_engine.h \
     qwt_text_label.h \
     qwt_text.h \
+    qwt_trace.h \
     qwt_transform.h \
     qwt_widget_overlay.h
 
@@ -83,6 +84,7 @@ SOURCES += \
     qwt_text_engine.cpp \
     qwt_text_label.cpp \
     qwt_text.cpp \
+    qwt_trace.cpp \
     qwt_transform.cpp \
     qwt_widget_overlay.cpp
 
@@ -98,6 +100,7 @@ contains(QWT_CONFIG, QwtPlot) {
         qwt_legend_label.h \
         qwt_plot.h \
         qwt_plot_renderer.h \
+        qwt_plot_batch_renderer.h \
         qwt_plot_curve.h \
         qwt_plot_dict.h \
         qwt_plot_directpainter.h \
@@ -134,6 +137,7 @@ contains(QWT_CONFIG, QwtPlot) {
         qwt_series_data.h \
         qwt_series_store.h \
         qwt_point_data.h \
+        qwt_histogram_data.h \
         qwt_scale_widget.h 
 
     SOURCES += \
@@ -144,6 +148,7 @@ contains(QWT_CONFIG, QwtPlot) {
         qwt_legend_label.cpp \
         qwt_plot.cpp \
         qwt_plot_renderer.cpp \
+        qwt_plot_batch_renderer.cpp \
         qwt_plot_xml.cpp \
         qwt_plot_axis.cpp \
         qwt_plot_curve.cpp \
@@ -180,6 +185,7 @@ contains(QWT_CONFIG, QwtPlot) {
         qwt_sampling_thread.cpp \
         qwt_series_data.cpp \
         qwt_point_data.cpp \
+        qwt_histogram_data.cpp \
         qwt_scale_widget.cpp 
 }
 